@@ -5,6 +5,8 @@ import PropTypes from 'prop-types'
 
 const MidiContext = createContext()
 
+const LED_AMOUNT = 24
+
 export const MidiProvider = ({ children }) => {
     const toast = useToast()
     const [isDemo, setDemo] = useState(false)
@@ -13,6 +15,9 @@ export const MidiProvider = ({ children }) => {
     const [isConnected, setIsConnected] = useState(false)
     const [selectedBank, setSelectedBank] = useState(0)
     const [ccMessages, setCcMessages] = useState([]) // New state variable for CC messages
+    // Mirrored LEDs as [r, g, b]: keys row by row, slider from position 0 up, then the status LED
+    const [leds, setLeds] = useState(Array(LED_AMOUNT).fill([0, 0, 0]))
+    const [ledMirror, setLedMirrorState] = useState(false)
     const [config, setConfig] = useState({
         version: 0,
         mode: 0,
@@ -249,6 +254,36 @@ export const MidiProvider = ({ children }) => {
                 setIsConnected(false)
             }
         }
+        if (e.data[1] === 127 && e.data[2] === 7 && e.data[3] === 7) {
+            setLeds((prevLeds) =>
+                decodeLedFrame(prevLeds, e.data.slice(4, e.data.length - 1))
+            )
+        }
+    }
+
+    // LED mirror frames carry 7 bit colors, a full frame (type 0) or only the changed LEDs (type 1)
+    const decodeLedFrame = (prevLeds, frame) => {
+        const nextLeds = [...prevLeds]
+        const toRgb = (i) => [frame[i] << 1, frame[i + 1] << 1, frame[i + 2] << 1]
+        if (frame[0] === 0) {
+            for (let led = 0; led < LED_AMOUNT; led++) {
+                nextLeds[led] = toRgb(1 + led * 3)
+            }
+        } else {
+            for (let i = 1; i + 3 < frame.length; i += 4) {
+                if (frame[i] < LED_AMOUNT) {
+                    nextLeds[frame[i]] = toRgb(i + 1)
+                }
+            }
+        }
+        return nextLeds
+    }
+
+    const setLedMirror = (enabled) => {
+        if (output) {
+            output.sendSysex(0x7e, [127, 7, 6, enabled ? 1 : 0])
+        }
+        setLedMirrorState(enabled)
     }
 
     const deserializeSysex = (sysex) => {
@@ -363,6 +398,9 @@ export const MidiProvider = ({ children }) => {
         setDemo,
         downloadConfig,
         uploadConfig,
+        leds,
+        ledMirror,
+        setLedMirror,
     }
 
     return (
@@ -1,6 +1,13 @@
 import * as React from 'react'
+import { PropTypes } from 'prop-types'
 
-const TopoT16Svg = (props) => (
+const KEY_X = [109.3, 163.2, 217, 270.9]
+const KEY_Y = [175.2, 229, 282.9, 336.7]
+const SLIDER_Y = [175.2, 202.1, 229.1, 256, 283, 309.9, 336.9]
+
+const ledColor = ([r, g, b]) => `rgb(${r}, ${g}, ${b})`
+
+const TopoT16Svg = ({ leds, ...props }) => (
     <svg
         xmlns="http://www.w3.org/2000/svg"
         xmlnsXlink="http://www.w3.org/1999/xlink"
@@ -1232,6 +1239,33 @@ const TopoT16Svg = (props) => (
                 </g>
             </g>
         </g>
+        {leds && (
+            <g id="LED_MIRROR" style={{ mixBlendMode: 'screen' }}>
+                {KEY_Y.map((cy, row) =>
+                    KEY_X.map((cx, col) => (
+                        <circle
+                            key={`key${row * 4 + col}`}
+                            cx={cx}
+                            cy={cy}
+                            r={19.8}
+                            fill={ledColor(leds[row * 4 + col])}
+                        />
+                    ))
+                )}
+                {/* slider position 0 sits at the bottom, on LED6 */}
+                {SLIDER_Y.map((cy, i) => (
+                    <rect
+                        key={`slider${i}`}
+                        x={64.4}
+                        y={cy - 9.5}
+                        width={9.1}
+                        height={19}
+                        rx={3}
+                        fill={ledColor(leds[16 + 6 - i])}
+                    />
+                ))}
+            </g>
+        )}
         <g id="INTRO" className="st36">
             <g id="usb" className="st37">
                 <line
@@ -1307,4 +1341,8 @@ const TopoT16Svg = (props) => (
     </svg>
 )
 
+TopoT16Svg.propTypes = {
+    leds: PropTypes.arrayOf(PropTypes.arrayOf(PropTypes.number)),
+}
+
 export default TopoT16Svg
@@ -9,6 +9,7 @@ import {
     GridItem,
 } from '@chakra-ui/react'
 import ControlChange from './ControlChange'
+import DeviceView from './DeviceView'
 import Keyboard from './Keyboard'
 import Scales from './Scales'
 
@@ -76,6 +77,25 @@ export default function Dashboard() {
                             <ControlChange />
                         </AccordionPanel>
                     </AccordionItem>
+                    <AccordionItem>
+                        <h2>
+                            <AccordionButton>
+                                <Box
+                                    as="span"
+                                    flex="1"
+                                    textAlign="left"
+                                    fontSize="xl"
+                                    letterSpacing={1}
+                                >
+                                    Device View
+                                </Box>
+                                <AccordionIcon />
+                            </AccordionButton>
+                        </h2>
+                        <AccordionPanel>
+                            <DeviceView />
+                        </AccordionPanel>
+                    </AccordionItem>
                 </Accordion>
             </GridItem>
         </Grid>
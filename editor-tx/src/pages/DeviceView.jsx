@@ -0,0 +1,25 @@
+import { Box, Flex, Stack } from '@chakra-ui/react'
+import { useContext } from 'react'
+import MidiContext from '../components/MidiProvider'
+import { ToggleCard } from '../components/ToggleCard'
+import TopoT16Svg from '../components/TopoT16Svg'
+
+export default function DeviceView() {
+    const { leds, ledMirror, setLedMirror } = useContext(MidiContext)
+
+    return (
+        <Stack spacing={4}>
+            <ToggleCard
+                name="Mirror LEDs"
+                id="led_mirror"
+                value={ledMirror ? 1 : 0}
+                onChange={(value) => setLedMirror(value === 1)}
+            />
+            <Flex justifyContent="center">
+                <Box w="300px">
+                    <TopoT16Svg leds={ledMirror ? leds : undefined} />
+                </Box>
+            </Flex>
+        </Stack>
+    )
+}
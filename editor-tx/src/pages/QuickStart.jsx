@@ -134,6 +134,16 @@ const content = [
             },
         ],
     },
+    {
+        title: 'Chord',
+        sections: [
+            {
+                content: `Chord mode plays a full chord with every key. Each key picks the chord built on its note
+                          from the notes of the selected scale, so every chord always stays in key. Velocity
+                          and pressure apply to the whole chord, the touchstrip works like in Keyboard mode.`,
+            },
+        ],
+    },
     {
         title: 'Joystick',
         sections: [
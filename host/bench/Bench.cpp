@@ -0,0 +1,104 @@
+// Runs the firmware's microbenchmarks (src/Libs/Benchmarks.hpp) on the host, the same cases the board
+// runs on 'b' over serial.
+//
+//   bench [--baseline table.txt [--threshold pct]]
+//
+// Prints the table in the board's format. --baseline compares the medians with a table saved from an
+// earlier run and fails when a case got slower by more than the threshold, 15% by default. Compare host
+// runs with host runs and board runs with board runs, the two clocks are comparable but the CPUs aren't.
+
+#include "pinout.h"
+#include <Arduino.h>
+#include <FastLED.h>
+#include "Libs/Leds/Palettes.hpp"
+#include "Libs/Benchmarks.hpp"
+
+#include <map>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+// Case name to median ns, from a table printed by Benchmarks::Run
+std::map<std::string, uint32_t> LoadBaseline(const char *path)
+{
+    std::map<std::string, uint32_t> medians;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string name;
+        uint32_t runs, median;
+        if (line.empty() || line[0] == '#' || !(fields >> name >> runs >> median))
+            continue;
+        medians[name] = median;
+    }
+    return medians;
+}
+
+int main(int argc, char **argv)
+{
+    const char *baseline = nullptr;
+    float threshold = 15.0f;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--baseline" && hasValue)
+            baseline = argv[++i];
+        else if (arg == "--threshold" && hasValue)
+            threshold = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--baseline table.txt [--threshold pct]]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::map<std::string, uint32_t> previous;
+    if (baseline)
+    {
+        previous = LoadBaseline(baseline);
+        if (previous.empty())
+        {
+            fprintf(stderr, "no results in %s\n", baseline);
+            return 2;
+        }
+    }
+
+    // The DataManager cases need somewhere to write
+    char root[] = "/tmp/t16bench.XXXXXX";
+    if (!mkdtemp(root))
+    {
+        fprintf(stderr, "can't set up the filesystem\n");
+        return 2;
+    }
+    LittleFS.SetRoot(root);
+    std::vector<Benchmark::Result> results = Benchmarks::Run(Serial);
+    rmdir(root);
+
+    if (!baseline)
+        return 0;
+
+    int slower = 0;
+    printf("\n%-20s %10s %10s %8s\n", "name", "was ns", "now ns", "change");
+    for (const Benchmark::Result &result : results)
+    {
+        auto found = previous.find(result.name);
+        if (found == previous.end())
+        {
+            printf("%-20s %10s %10u %8s\n", result.name, "-", (unsigned)result.median, "new");
+            continue;
+        }
+        float change = found->second ? 100.0f * ((float)result.median - found->second) / found->second : 0.0f;
+        bool regressed = change > threshold;
+        slower += regressed;
+        printf("%-20s %10u %10u %+7.1f%%%s\n", result.name, (unsigned)found->second, (unsigned)result.median, change,
+               regressed ? " slower" : "");
+    }
+    if (slower)
+        printf("%d case%s slower than %.0f%% over the baseline\n", slower, slower > 1 ? "s" : "", threshold);
+    return slower ? 1 : 0;
+}
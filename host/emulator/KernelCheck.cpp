@@ -0,0 +1,190 @@
+// Compares the fixed point LED kernels with the float code they replaced, pixel for pixel.
+//
+//   kernel_check [--step n]
+//
+// TouchBlur is rendered at every 8.8 position over the matrix (every n-th with --step), each position with
+// the next blur amount and another color, next to the float TouchBlur it replaced. Strips is rendered at
+// every 8.8 value of every strip next to the float wu_pixel_1d. The float code writes off the matrix the
+// way it used to, into a buffer of its own large enough to take it. Exits 1 on the first differing pixel.
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <string>
+
+#include "Libs/Leds/Palettes.hpp"
+#include "Libs/Leds/LedManager.hpp"
+
+// The float kernels before the fixed point rewrite
+namespace Reference
+{
+    CRGB leds[0x10000]; // off the matrix XY() gave 0xFFFF
+
+    uint16_t XY(uint8_t x, uint8_t y)
+    {
+        if (x >= kMatrixWidth || y >= kMatrixHeight)
+            return 0xFFFF;
+        return Matrix::Index(x, y);
+    }
+
+    void wu_pixel(uint32_t x, uint32_t y, CRGB *col)
+    {
+        uint8_t xx = x & 0xff, yy = y & 0xff, ix = 255 - xx, iy = 255 - yy;
+        uint8_t wu[4] = {WEIGHT(ix, iy), WEIGHT(xx, iy), WEIGHT(ix, yy), WEIGHT(xx, yy)};
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            uint16_t xy = XY((x >> 8) + (i & 1), (y >> 8) + ((i >> 1) & 1));
+            leds[xy].r = qadd8(leds[xy].r, (col->r * wu[i]) >> 8);
+            leds[xy].g = qadd8(leds[xy].g, (col->g * wu[i]) >> 8);
+            leds[xy].b = qadd8(leds[xy].b, (col->b * wu[i]) >> 8);
+        }
+    }
+
+    void wu_pixel_1d(uint8_t x, uint32_t y, CRGB *col)
+    {
+        uint32_t iy = y >> 8;
+        uint8_t fy = y & 0xFF;
+        uint8_t ify = 255 - fy;
+        uint8_t w[2] = {WEIGHT(ify, 255), WEIGHT(fy, 255)};
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            uint16_t xy = XY(x, iy + i);
+            leds[xy].r = qadd8(leds[xy].r, (col->r * w[i]) >> 8);
+            leds[xy].g = qadd8(leds[xy].g, (col->g * w[i]) >> 8);
+            leds[xy].b = qadd8(leds[xy].b, (col->b * w[i]) >> 8);
+        }
+    }
+
+    uint8_t luma[10][16];
+
+    void GenerateLut()
+    {
+        CRGB lumaleds[16];
+        fill_solid(lumaleds, 16, CRGB::Black);
+        lumaleds[0] = CRGB::White;
+        for (int j = 0; j < 10; j++)
+        {
+            blur2d(lumaleds, 4, 4, 2 + j * 4);
+            lumaleds[0] = CRGB::White;
+            for (int i = 0; i < 16; i++)
+                luma[9 - j][i] = brighten8_raw(lumaleds[i].getLuma());
+        }
+    }
+
+    void TouchBlur(float pos_x, float pos_y, uint8_t step, uint8_t colorIndex)
+    {
+        fill_solid(leds, Matrix::SIZE, CRGB::Black);
+        for (int x = 0; x < 4; x++)
+        {
+            for (int y = 0; y < 4; y++)
+            {
+                float new_x = (pos_x - (uint8_t)pos_x) + (float)x;
+                float new_y = (pos_y - (uint8_t)pos_y) + (float)y;
+                uint8_t luma_value = luma[step][abs(x - (uint8_t)pos_x) + abs(y - (uint8_t)pos_y) * 4];
+                CRGB color = ColorFromPalette(Pattern::currentPalette, colorIndex, luma_value, LINEARBLEND_NOWRAP);
+                Reference::wu_pixel(static_cast<int32_t>(new_x * (1 << 8)), static_cast<int32_t>(new_y * (1 << 8)), &color);
+            }
+        }
+    }
+
+    void Strips(const float *strips, uint8_t colorIndex)
+    {
+        fill_solid(leds, Matrix::SIZE, CRGB::Black);
+        CRGB color = ColorFromPalette(Pattern::currentPalette, colorIndex, 255, LINEARBLEND_NOWRAP);
+        for (uint8_t i = 0; i < 4; i++)
+            Reference::wu_pixel_1d(i, static_cast<uint32_t>(strips[i] * (1 << 8)), &color);
+    }
+}
+
+// Index of the first pixel that differs, -1 when the frames match
+int Compare()
+{
+    for (uint16_t i = 0; i < Matrix::SIZE; i++)
+    {
+        if (patternleds[i] != Reference::leds[i])
+            return i;
+    }
+    return -1;
+}
+
+void Report(const char *name, const char *where, int pixel)
+{
+    const CRGB &got = patternleds[pixel], &expected = Reference::leds[pixel];
+    printf("FAIL: %s %s, led %d is %02x%02x%02x, the float code gives %02x%02x%02x\n", name, where, pixel, got.r, got.g,
+           got.b, expected.r, expected.g, expected.b);
+}
+
+int main(int argc, char **argv)
+{
+    int stride = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--step" && i + 1 < argc)
+            stride = atoi(argv[++i]) > 0 ? atoi(argv[i]) : 1;
+        else
+        {
+            fprintf(stderr, "usage: %s [--step n]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static const uint8_t colors[] = {0, 37, 96, 128, 200, 255};
+    Reference::GenerateLut();
+
+    TouchBlur touch_blur;
+    Pattern::SetPalette(unwn_gp);
+    uint32_t frames = 0;
+    for (uint16_t fy = 0; fy < kMatrixHeight << 8; fy += stride)
+    {
+        for (uint16_t fx = 0; fx < kMatrixWidth << 8; fx += stride)
+        {
+            float x = fx / 256.0f, y = fy / 256.0f;
+            uint8_t step = frames % 10;
+            uint8_t color = colors[frames % sizeof(colors)];
+            touch_blur.SetAmount(step / 9.0f);
+            touch_blur.SetColor(color);
+            touch_blur.SetPosition(x, y);
+            touch_blur.RunPattern(16);
+            Reference::TouchBlur(x, y, step, color);
+            frames++;
+            int pixel = Compare();
+            if (pixel >= 0)
+            {
+                char where[64];
+                snprintf(where, sizeof(where), "at %.4f, %.4f amount %u color %u", x, y, step, color);
+                Report("touch_blur", where, pixel);
+                return 1;
+            }
+        }
+    }
+    printf("touch_blur: %u positions match\n", frames);
+
+    Strips strips;
+    Pattern::SetPalette(acid_gp);
+    frames = 0;
+    for (uint16_t value = 0; value < kMatrixHeight << 8; value++)
+    {
+        // every strip at a different value, all of them cover the whole range
+        float values[4];
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            values[i] = ((value + i * 97) % (kMatrixHeight << 8)) / 256.0f;
+            strips.SetStrip(i, values[i]);
+        }
+        uint8_t color = colors[value % sizeof(colors)];
+        strips.SetColor(color);
+        strips.RunPattern(16);
+        Reference::Strips(values, color);
+        frames++;
+        int pixel = Compare();
+        if (pixel >= 0)
+        {
+            char where[64];
+            snprintf(where, sizeof(where), "at %.4f %.4f %.4f %.4f color %u", values[0], values[1], values[2], values[3], color);
+            Report("strips", where, pixel);
+            return 1;
+        }
+    }
+    printf("strips: %u values match\n", frames);
+    return 0;
+}
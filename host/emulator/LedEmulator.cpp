@@ -0,0 +1,493 @@
+// Renders the LED patterns on the host, against the stand-ins in host/include.
+//
+//   led_emulator <scene> [--ppm out.ppm] [--gif out.gif] [--scale n] [--golden file.ppm [--record]] [--log]
+//
+// A scene is a text file of timed commands, see host/emulator/scenes. Frames are rendered on a virtual
+// clock at the LedManager frame rate, so the same scene always gives the same frames whatever the host.
+// --golden compares the frames with a sheet recorded earlier with --record and fails on any difference.
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+
+#include "Libs/Leds/Palettes.hpp"
+#include "Libs/Leds/LedManager.hpp"
+
+LedManager led_manager;
+
+TouchBlur touch_blur;
+Ripples ripples;
+Strips strips;
+Strum strum;
+QuickSettings quick;
+Drops drops;
+Sea sea;
+Sea2 sea2;
+NoBlur no_blur;
+
+std::map<std::string, Pattern *> patterns = {
+    {"touch_blur", &touch_blur},
+    {"ripples", &ripples},
+    {"strips", &strips},
+    {"strum", &strum},
+    {"quick", &quick},
+    {"drops", &drops},
+    {"sea", &sea},
+    {"sea2", &sea2},
+    {"no_blur", &no_blur},
+};
+
+// One frame image: the matrix, a spacer column with the status LED on top, and the slider bottom to top
+#define FRAME_WIDTH (Matrix::WIDTH + 2)
+#define FRAME_HEIGHT (Matrix::HEIGHT > Slider::LENGTH ? Matrix::HEIGHT : Slider::LENGTH)
+
+struct Event
+{
+    uint32_t time;
+    std::string command;
+    std::vector<std::string> args;
+    int line;
+};
+
+class Scene
+{
+public:
+    bool Load(const char *path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            fprintf(stderr, "can't open scene %s\n", path);
+            return false;
+        }
+        std::string text;
+        int line = 0;
+        while (std::getline(file, text))
+        {
+            line++;
+            size_t comment = text.find('#');
+            if (comment != std::string::npos)
+                text.erase(comment);
+            std::istringstream words(text);
+            Event event;
+            if (!(words >> event.time >> event.command))
+                continue;
+            std::string arg;
+            while (words >> arg)
+                event.args.push_back(arg);
+            event.line = line;
+            if (event.command == "end")
+                duration = event.time;
+            else
+                events.push_back(event);
+        }
+        if (duration == 0)
+            duration = events.empty() ? 1000 : events.back().time + 1000;
+        return true;
+    }
+
+    std::vector<Event> events;
+    uint32_t duration = 0;
+};
+
+class FrameSheet
+{
+public:
+    void Capture()
+    {
+        std::vector<CRGB> frame(FRAME_WIDTH * FRAME_HEIGHT, CRGB::Black);
+        for (uint8_t y = 0; y < Matrix::HEIGHT; y++)
+        {
+            for (uint8_t x = 0; x < Matrix::WIDTH; x++)
+            {
+                frame[y * FRAME_WIDTH + x] = matrixleds[Matrix::Index(x, y)];
+            }
+        }
+        frame[Matrix::WIDTH] = stateled[0];
+        for (uint8_t i = 0; i < Slider::LENGTH; i++)
+        {
+            frame[(FRAME_HEIGHT - 1 - i) * FRAME_WIDTH + Matrix::WIDTH + 1] = sliderleds[Slider::Index(i)];
+        }
+        frames.push_back(frame);
+    }
+
+    size_t Count() const { return frames.size(); }
+
+    // Frames stacked top to bottom, every LED a scale x scale block, with a dark grid when scaled up
+    bool WritePpm(const char *path, uint8_t scale) const
+    {
+        uint16_t width, height;
+        std::vector<CRGB> image = Layout(scale, width, height);
+        FILE *file = fopen(path, "wb");
+        if (!file)
+            return false;
+        fprintf(file, "P6\n%u %u\n255\n", width, height);
+        fwrite(image.data(), sizeof(CRGB), image.size(), file);
+        fclose(file);
+        return true;
+    }
+
+    bool ReadPpm(const char *path)
+    {
+        FILE *file = fopen(path, "rb");
+        if (!file)
+            return false;
+        unsigned width, height, depth;
+        bool ok = fscanf(file, "P6 %u %u %u", &width, &height, &depth) == 3 && fgetc(file) != EOF &&
+                  width == FRAME_WIDTH && depth == 255 && height % FRAME_HEIGHT == 0;
+        if (ok)
+        {
+            frames.assign(height / FRAME_HEIGHT, std::vector<CRGB>(FRAME_WIDTH * FRAME_HEIGHT));
+            for (auto &frame : frames)
+                ok = ok && fread(frame.data(), sizeof(CRGB), frame.size(), file) == frame.size();
+        }
+        fclose(file);
+        return ok;
+    }
+
+    // Returns the first frame that differs, or -1
+    int Compare(const FrameSheet &other, int &pixel) const
+    {
+        size_t count = frames.size() < other.frames.size() ? frames.size() : other.frames.size();
+        for (size_t f = 0; f < count; f++)
+        {
+            for (size_t i = 0; i < frames[f].size(); i++)
+            {
+                if (frames[f][i] != other.frames[f][i])
+                {
+                    pixel = i;
+                    return f;
+                }
+            }
+        }
+        pixel = -1;
+        return frames.size() == other.frames.size() ? -1 : count;
+    }
+
+    // Animated GIF with a 3-3-2 palette, frameTime in ms
+    bool WriteGif(const char *path, uint8_t scale, uint16_t frameTime) const
+    {
+        FILE *file = fopen(path, "wb");
+        if (!file)
+            return false;
+        uint16_t width = FRAME_WIDTH * scale, height = FRAME_HEIGHT * scale;
+
+        fwrite("GIF89a", 1, 6, file);
+        Put16(file, width);
+        Put16(file, height);
+        fputc(0xF7, file); // global color table of 256 entries
+        fputc(0, file);
+        fputc(0, file);
+        for (uint16_t i = 0; i < 256; i++)
+        {
+            fputc(((i >> 5) & 0x07) * 255 / 7, file);
+            fputc(((i >> 2) & 0x07) * 255 / 7, file);
+            fputc((i & 0x03) * 255 / 3, file);
+        }
+        // loop forever
+        const uint8_t loop[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00};
+        fwrite(loop, 1, sizeof(loop), file);
+
+        uint16_t delay = (frameTime + 5) / 10;
+        for (size_t f = 0; f < frames.size(); f++)
+        {
+            const uint8_t control[] = {0x21, 0xF9, 0x04, 0x00, (uint8_t)(delay & 0xFF), (uint8_t)(delay >> 8), 0x00, 0x00};
+            fwrite(control, 1, sizeof(control), file);
+            fputc(0x2C, file);
+            Put16(file, 0);
+            Put16(file, 0);
+            Put16(file, width);
+            Put16(file, height);
+            fputc(0, file);
+
+            std::vector<uint8_t> indices;
+            for (uint16_t y = 0; y < height; y++)
+            {
+                for (uint16_t x = 0; x < width; x++)
+                {
+                    const CRGB &c = frames[f][(y / scale) * FRAME_WIDTH + x / scale];
+                    indices.push_back((c.r & 0xE0) | ((c.g >> 3) & 0x1C) | (c.b >> 6));
+                }
+            }
+            WriteLzw(file, indices);
+        }
+        fputc(0x3B, file);
+        fclose(file);
+        return true;
+    }
+
+private:
+    std::vector<std::vector<CRGB>> frames;
+
+    std::vector<CRGB> Layout(uint8_t scale, uint16_t &width, uint16_t &height) const
+    {
+        width = FRAME_WIDTH * scale;
+        height = FRAME_HEIGHT * scale * frames.size();
+        std::vector<CRGB> image(width * height, CRGB::Black);
+        for (size_t f = 0; f < frames.size(); f++)
+        {
+            for (uint16_t y = 0; y < FRAME_HEIGHT * scale; y++)
+            {
+                for (uint16_t x = 0; x < width; x++)
+                {
+                    bool grid = scale > 2 && (x % scale == 0 || y % scale == 0);
+                    CRGB pixel = frames[f][(y / scale) * FRAME_WIDTH + x / scale];
+                    image[(f * FRAME_HEIGHT * scale + y) * width + x] = grid ? CRGB(16, 16, 16) : pixel;
+                }
+            }
+        }
+        return image;
+    }
+
+    static void Put16(FILE *file, uint16_t value)
+    {
+        fputc(value & 0xFF, file);
+        fputc(value >> 8, file);
+    }
+
+    // Uncompressed LZW: 9 bit literal codes, with a clear code before the table would grow past 9 bits
+    static void WriteLzw(FILE *file, const std::vector<uint8_t> &indices)
+    {
+        const uint16_t CLEAR = 256, END = 257;
+        std::vector<uint8_t> bytes;
+        uint32_t bits = 0;
+        uint8_t bitCount = 0;
+        auto emit = [&](uint16_t code)
+        {
+            bits |= (uint32_t)code << bitCount;
+            bitCount += 9;
+            while (bitCount >= 8)
+            {
+                bytes.push_back(bits & 0xFF);
+                bits >>= 8;
+                bitCount -= 8;
+            }
+        };
+
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            if (i % 250 == 0)
+                emit(CLEAR);
+            emit(indices[i]);
+        }
+        emit(END);
+        if (bitCount > 0)
+            bytes.push_back(bits & 0xFF);
+
+        fputc(8, file); // minimum code size
+        for (size_t i = 0; i < bytes.size(); i += 255)
+        {
+            uint8_t length = bytes.size() - i > 255 ? 255 : bytes.size() - i;
+            fputc(length, file);
+            fwrite(&bytes[i], 1, length, file);
+        }
+        fputc(0, file);
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t offMatrixWrites = 0;
+
+// Off-matrix writes land in the safety pixels, count and clear them so they don't pile up unseen
+void CheckSafetyPixels()
+{
+    CRGB *layers[] = {markerleds, patternleds, feedbackleds};
+    for (CRGB *layer : layers)
+    {
+        if (layer[Matrix::SIZE] != CRGB(CRGB::Black))
+        {
+            offMatrixWrites++;
+            layer[Matrix::SIZE] = CRGB::Black;
+        }
+    }
+}
+
+Pattern *FindPattern(const std::string &name)
+{
+    auto found = patterns.find(name);
+    return found == patterns.end() ? nullptr : found->second;
+}
+
+uint8_t ToKey(const std::string &arg) { return atoi(arg.c_str()) % Matrix::SIZE; }
+
+bool Apply(const Event &event)
+{
+    const std::string &cmd = event.command;
+    const std::vector<std::string> &a = event.args;
+    auto arg = [&](size_t i)
+    { return i < a.size() ? atof(a[i].c_str()) : 0.0; };
+
+    if (cmd == "pattern" || cmd == "transition")
+    {
+        Pattern *pattern = a.empty() ? nullptr : FindPattern(a[0]);
+        if (!pattern)
+        {
+            fprintf(stderr, "line %d: unknown pattern\n", event.line);
+            return false;
+        }
+        // a pattern returning false hands over to the next one, which has to be itself here
+        led_manager.TransitionToPattern(pattern);
+        if (cmd == "pattern")
+            led_manager.SetPattern(pattern);
+    }
+    else if (cmd == "palette")
+        Pattern::SetPalette(palette[(int)arg(0) & 3]);
+    else if (cmd == "fade")
+        led_manager.SetPalette(palette[(int)arg(0) & 3]);
+    else if (cmd == "note_on")
+        led_manager.NoteOn(ToKey(a[0]), arg(1));
+    else if (cmd == "note_off")
+        led_manager.NoteOff(ToKey(a[0]));
+    else if (cmd == "pressure")
+        led_manager.NotePressure(ToKey(a[0]), arg(1));
+    else if (cmd == "touch")
+        led_manager.SetPosition((uint8_t)(ToKey(a[0]) % Matrix::WIDTH), (uint8_t)(ToKey(a[0]) / Matrix::WIDTH));
+    else if (cmd == "position")
+        led_manager.SetPosition((float)arg(0), (float)arg(1));
+    else if (cmd == "strip")
+        led_manager.SetStrip(arg(0), arg(1));
+    else if (cmd == "color")
+        led_manager.SetColor(arg(0));
+    else if (cmd == "speed")
+        led_manager.SetSpeed(arg(0));
+    else if (cmd == "amount")
+        led_manager.SetAmount(arg(0));
+    else if (cmd == "state")
+        led_manager.SetState(arg(0) != 0);
+    else if (cmd == "note")
+        led_manager.SetNote(arg(0));
+    else if (cmd == "chord")
+        led_manager.SetChord(arg(0));
+    else if (cmd == "option")
+        led_manager.SetOption(arg(0), arg(1));
+    else if (cmd == "value")
+        led_manager.SetValue(arg(0), arg(1));
+    else if (cmd == "marker")
+    {
+        led_manager.SetMarker(ToKey(a[0]), arg(1) != 0);
+        led_manager.DrawMarkers();
+    }
+    else if (cmd == "led")
+        led_manager.SetLed(ToKey(a[0]), arg(1) != 0);
+    else if (cmd == "slider")
+        led_manager.SetSlider((float)arg(0));
+    else if (cmd == "status")
+        led_manager.SetStatus(arg(0) != 0);
+    else
+    {
+        fprintf(stderr, "line %d: unknown command %s\n", event.line, cmd.c_str());
+        return false;
+    }
+    return true;
+}
+
+int RunScene(const char *path, const char *ppm, const char *gif, const char *golden, bool record, uint8_t scale)
+{
+    Scene scene;
+    if (!scene.Load(path))
+        return 2;
+
+    const uint16_t period = 1000 / LED_FRAME_RATE;
+    FrameSheet sheet;
+    size_t next = 0;
+    HostClock::Reset();
+    while (millis() < scene.duration)
+    {
+        HostClock::Advance(period * 1000UL);
+        while (next < scene.events.size() && scene.events[next].time <= millis())
+        {
+            if (!Apply(scene.events[next++]))
+                return 2;
+        }
+        led_manager.Render();
+        CheckSafetyPixels();
+        sheet.Capture();
+    }
+    printf("%s: %zu frames, %u off-matrix writes\n", path, sheet.Count(), offMatrixWrites);
+
+    if (ppm && !sheet.WritePpm(ppm, scale))
+        fprintf(stderr, "can't write %s\n", ppm);
+    if (gif && !sheet.WriteGif(gif, scale, period))
+        fprintf(stderr, "can't write %s\n", gif);
+
+    // XY() clipped them, but a pattern that draws off the matrix is wrong on any other geometry
+    if (offMatrixWrites > 0)
+    {
+        printf("FAIL: %u off-matrix writes\n", offMatrixWrites);
+        return 1;
+    }
+
+    if (golden && record)
+    {
+        if (!sheet.WritePpm(golden, 1))
+        {
+            fprintf(stderr, "can't write %s\n", golden);
+            return 2;
+        }
+        printf("recorded %s\n", golden);
+    }
+    else if (golden)
+    {
+        FrameSheet reference;
+        if (!reference.ReadPpm(golden))
+        {
+            fprintf(stderr, "can't read golden %s\n", golden);
+            return 2;
+        }
+        int pixel;
+        int frame = sheet.Compare(reference, pixel);
+        if (frame >= 0)
+        {
+            if (pixel >= 0)
+                printf("FAIL: frame %d differs at x %d y %d\n", frame, pixel % FRAME_WIDTH, pixel / FRAME_WIDTH);
+            else
+                printf("FAIL: %zu frames, golden has %zu\n", sheet.Count(), reference.Count());
+            return 1;
+        }
+        printf("matches %s\n", golden);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *scene = nullptr, *ppm = nullptr, *gif = nullptr, *golden = nullptr;
+    bool record = false;
+    uint8_t scale = 16;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--ppm" && hasValue)
+            ppm = argv[++i];
+        else if (arg == "--gif" && hasValue)
+            gif = argv[++i];
+        else if (arg == "--golden" && hasValue)
+            golden = argv[++i];
+        else if (arg == "--scale" && hasValue)
+            scale = atoi(argv[++i]) > 0 ? atoi(argv[i]) : 1;
+        else if (arg == "--record")
+            record = true;
+        else if (arg == "--log")
+            HostLog::Enabled() = true;
+        else
+            scene = argv[i];
+    }
+
+    led_manager.Init();
+    led_manager.SetPattern(&touch_blur);
+
+    if (!scene)
+    {
+        fprintf(stderr, "usage: %s <scene> [--ppm out.ppm] [--gif out.gif] [--scale n] [--golden file.ppm [--record]] [--log]\n",
+                argv[0]);
+        return 2;
+    }
+    return RunScene(scene, ppm, gif, golden, record, scale);
+}
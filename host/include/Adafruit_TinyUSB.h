@@ -0,0 +1,55 @@
+#ifndef HOST_ADAFRUIT_TINYUSB_H
+#define HOST_ADAFRUIT_TINYUSB_H
+
+// USB MIDI stand-in, a byte stream like the TinyUSB one. There is a single USB port, what the firmware
+// writes is kept in HostUsb::Written() and what the host puts in HostUsb::Received() is read back as MIDI.
+
+#include "Arduino.h"
+
+namespace HostUsb
+{
+    inline std::vector<uint8_t> &Written()
+    {
+        static std::vector<uint8_t> written;
+        return written;
+    }
+
+    inline std::deque<uint8_t> &Received()
+    {
+        static std::deque<uint8_t> received;
+        return received;
+    }
+}
+
+class Adafruit_USBD_MIDI
+{
+public:
+    bool begin() { return true; }
+    void begin(unsigned long baud) {}
+    void setStringDescriptor(const char *descriptor) {}
+
+    int available() { return HostUsb::Received().size(); }
+
+    int read()
+    {
+        if (HostUsb::Received().empty())
+            return -1;
+        uint8_t value = HostUsb::Received().front();
+        HostUsb::Received().pop_front();
+        return value;
+    }
+
+    size_t write(uint8_t value)
+    {
+        HostUsb::Written().push_back(value);
+        return 1;
+    }
+
+    size_t write(const uint8_t *data, size_t size)
+    {
+        HostUsb::Written().insert(HostUsb::Written().end(), data, data + size);
+        return size;
+    }
+};
+
+#endif // HOST_ADAFRUIT_TINYUSB_H
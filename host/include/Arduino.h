@@ -0,0 +1,360 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-in for the parts of the ESP32 Arduino core the firmware uses.
+// Time is virtual: it only moves when the host advances it, so runs are repeatable.
+// GPIO, the ADC and the serial ports are simulated, the host drives inputs and reads outputs
+// through the Host* namespaces.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+typedef unsigned long ulong;
+typedef uint8_t byte;
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+using std::abs;
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+namespace HostClock
+{
+    inline uint64_t &Now()
+    {
+        static uint64_t now = 0; // us
+        return now;
+    }
+
+    inline void Advance(uint32_t us) { Now() += us; }
+    inline void Reset() { Now() = 0; }
+}
+
+inline ulong millis() { return HostClock::Now() / 1000; }
+inline ulong micros() { return HostClock::Now(); }
+inline void delay(uint32_t ms) { HostClock::Advance(ms * 1000UL); }
+inline void delayMicroseconds(uint32_t us) { HostClock::Advance(us); }
+
+// Logging is off unless the host turns it on, frame loops would drown the output
+namespace HostLog
+{
+    inline bool &Enabled()
+    {
+        static bool enabled = false;
+        return enabled;
+    }
+}
+
+#define log_d(format, ...)                                         \
+    do                                                             \
+    {                                                              \
+        if (HostLog::Enabled())                                    \
+            fprintf(stderr, "[D] " format "\n", ##__VA_ARGS__);    \
+    } while (0)
+#define log_i(format, ...) log_d(format, ##__VA_ARGS__)
+#define log_w(format, ...) log_d(format, ##__VA_ARGS__)
+#define log_e(format, ...) fprintf(stderr, "[E] " format "\n", ##__VA_ARGS__)
+
+// GPIO
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+namespace HostGpio
+{
+    static const uint8_t PIN_AMOUNT = 49; // ESP32-S3
+
+    struct Pin
+    {
+        uint8_t mode = 0;
+        uint8_t level = LOW;
+        void (*isr)(void *) = nullptr;
+        void *arg = nullptr;
+        int edges = 0;
+    };
+
+    inline Pin &Get(uint8_t pin)
+    {
+        static Pin pins[PIN_AMOUNT];
+        return pins[pin < PIN_AMOUNT ? pin : 0];
+    }
+
+    // Drives an input from outside, like a button contact, running its interrupt on a matching edge
+    inline void Set(uint8_t pin, uint8_t level)
+    {
+        Pin &state = Get(pin);
+        if (state.level == level)
+            return;
+        state.level = level;
+        int edge = level == HIGH ? RISING : FALLING;
+        if (state.isr && (state.edges & edge))
+            state.isr(state.arg);
+    }
+}
+
+inline void pinMode(uint8_t pin, uint8_t mode)
+{
+    HostGpio::Get(pin).mode = mode;
+    if (mode == INPUT_PULLUP)
+        HostGpio::Get(pin).level = HIGH;
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t level) { HostGpio::Get(pin).level = level ? HIGH : LOW; }
+inline int digitalRead(uint8_t pin) { return HostGpio::Get(pin).level; }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline int digitalPinToTouchChannel(uint8_t pin) { return pin; } // the S3 touch channels follow the GPIO numbers
+
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode)
+{
+    HostGpio::Pin &state = HostGpio::Get(pin);
+    state.isr = isr;
+    state.arg = arg;
+    state.edges = mode;
+}
+
+inline void detachInterrupt(uint8_t pin) { HostGpio::Get(pin).isr = nullptr; }
+
+// ADC, the host decides what every conversion returns. It can look at the GPIO levels, a mux for example.
+
+typedef enum
+{
+    ADC_0db,
+    ADC_2_5db,
+    ADC_6db,
+    ADC_11db
+} adc_attenuation_t;
+
+namespace HostAnalog
+{
+    inline std::function<uint16_t(uint8_t pin)> &Source()
+    {
+        static std::function<uint16_t(uint8_t)> source;
+        return source;
+    }
+}
+
+inline uint16_t analogRead(uint8_t pin)
+{
+    auto &source = HostAnalog::Source();
+    return source ? source(pin) : 0;
+}
+
+inline void analogSetAttenuation(adc_attenuation_t attenuation) {}
+
+// Arduino String, just enough for building text to print
+class String : public std::string
+{
+public:
+    String(const char *text = "") : std::string(text) {}
+    String(const std::string &text) : std::string(text) {}
+    String(int value) : std::string(std::to_string(value)) {}
+    String(unsigned value) : std::string(std::to_string(value)) {}
+    String(long value) : std::string(std::to_string(value)) {}
+    String(unsigned long value) : std::string(std::to_string(value)) {}
+    String(float value, uint8_t decimals = 2) : String(Format(value, decimals)) {}
+    String(double value, uint8_t decimals = 2) : String(Format(value, decimals)) {}
+
+    String operator+(const String &other) const { return String(static_cast<const std::string &>(*this) + other); }
+    String operator+(const char *text) const { return String(static_cast<const std::string &>(*this) + text); }
+    friend String operator+(const char *text, const String &other) { return String(text) + other; }
+
+private:
+    static std::string Format(double value, uint8_t decimals)
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        return buffer;
+    }
+};
+
+// Serial ports, what is written is kept for the host, what the host injects can be read
+
+#define SERIAL_8N1 0x800001c
+
+class HostSerial
+{
+public:
+    HostSerial(FILE *echo = nullptr) : echo(echo) {}
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rx = -1, int8_t tx = -1) {}
+    void end() {}
+    void setDebugOutput(bool enabled) {}
+    void flush()
+    {
+        if (echo)
+            fflush(echo);
+    }
+
+    int available() { return input.size(); }
+
+    int read()
+    {
+        if (input.empty())
+            return -1;
+        uint8_t value = input.front();
+        input.pop_front();
+        return value;
+    }
+
+    int peek() { return input.empty() ? -1 : input.front(); }
+
+    size_t write(uint8_t value)
+    {
+        written.push_back(value);
+        if (echo)
+            fputc(value, echo);
+        return 1;
+    }
+
+    size_t write(const uint8_t *data, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            write(data[i]);
+        return size;
+    }
+
+    size_t print(const char *text) { return write(reinterpret_cast<const uint8_t *>(text), strlen(text)); }
+    size_t println(const char *text = "") { return print(text) + print("\r\n"); }
+    size_t print(const String &text) { return print(text.c_str()); }
+    size_t println(const String &text) { return println(text.c_str()); }
+
+    int printf(const char *format, ...)
+    {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        print(buffer);
+        return length;
+    }
+
+    // Host side
+    void SetEcho(FILE *file) { echo = file; }
+    void Inject(const uint8_t *data, size_t size) { input.insert(input.end(), data, data + size); }
+    std::vector<uint8_t> &Written() { return written; }
+
+private:
+    FILE *echo;
+    std::deque<uint8_t> input;
+    std::vector<uint8_t> written;
+};
+
+typedef HostSerial HardwareSerial;
+
+inline HostSerial Serial(stdout);
+inline HostSerial Serial2;
+
+// Heap behind ESP.getFreeHeap(). A tool that replaces operator new and delete keeps what the firmware holds in
+// Used(), the free heap is the ESP32-S3's internal RAM less that. Without one the heap stays empty.
+namespace HostHeap
+{
+    static const size_t SIZE = 320 * 1024;
+
+    inline size_t &Used()
+    {
+        static size_t used = 0;
+        return used;
+    }
+
+    // allocations so far, freed or not
+    inline size_t &Allocations()
+    {
+        static size_t allocations = 0;
+        return allocations;
+    }
+}
+
+// Cycle counts follow the wall clock at the ESP32-S3's 240 MHz, only good for relative costs
+class HostEsp
+{
+public:
+    uint32_t getCycleCount()
+    {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        return static_cast<uint32_t>(ns * 240 / 1000);
+    }
+    uint32_t getFreeHeap() { return HostHeap::SIZE - HostHeap::Used(); }
+    uint32_t getCpuFreqMHz() { return 240; }
+
+    void restart()
+    {
+        fprintf(stderr, "ESP.restart()\n");
+        exit(0);
+    }
+};
+
+inline HostEsp ESP;
+
+// FreeRTOS, tasks are never started on the host. Whoever needs their work done calls it directly.
+// A tick is a millisecond.
+typedef void *TaskHandle_t;
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void *);
+typedef struct
+{
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portYIELD_FROM_ISR() ((void)0)
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define tskIDLE_PRIORITY 0
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define IRAM_ATTR
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack, void *parameters, uint32_t priority, TaskHandle_t *handle, int core)
+{
+    if (handle)
+        *handle = nullptr;
+    return pdPASS;
+}
+
+inline void xTaskNotifyGive(TaskHandle_t task) {}
+inline void vTaskDelay(uint32_t ticks) { HostClock::Advance(ticks * 1000UL); }
+inline TickType_t xTaskGetTickCount() { return millis(); }
+inline void vTaskDelayUntil(TickType_t *previous, TickType_t ticks)
+{
+    *previous += ticks;
+    if (*previous > millis())
+        HostClock::Advance((*previous - millis()) * 1000UL);
+}
+inline int xPortGetCoreID() { return 0; }
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, uint32_t ticks) { return 0; }
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,43 @@
+#ifndef HOST_BLEMIDI_TRANSPORT_H
+#define HOST_BLEMIDI_TRANSPORT_H
+
+// BLE MIDI transport stand-in with the calls MidiInterface makes. There is no radio and no BLE
+// packet framing: messages are kept as plain MIDI bytes in HostBle::Written(), nothing is ever received.
+
+#include "Arduino.h"
+#include <MIDI.h>
+
+namespace HostBle
+{
+    inline std::vector<uint8_t> &Written()
+    {
+        static std::vector<uint8_t> written;
+        return written;
+    }
+}
+
+namespace bleMidi
+{
+    struct DefaultSettings
+    {
+        static const size_t MaxBufferSize = 64;
+    };
+
+    template <class T, class _Settings = DefaultSettings>
+    class BLEMIDI_Transport
+    {
+    public:
+        BLEMIDI_Transport(const char *deviceName) {}
+
+        static const bool thruActivated = false;
+
+        void begin() {}
+        bool beginTransmission(midi::MidiType type) { return true; }
+        void write(byte value) { HostBle::Written().push_back(value); }
+        void endTransmission() {}
+        byte read() { return 0; }
+        unsigned available() { return 0; }
+    };
+}
+
+#endif // HOST_BLEMIDI_TRANSPORT_H
@@ -0,0 +1,822 @@
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+// Host stand-in for the subset of FastLED 3.6 used by the LED code.
+// The math follows FastLED's C fallbacks (FASTLED_SCALE8_FIXED) and the noise is a port of its 8 bit
+// Perlin noise, so host frames track the device's closely, though not guaranteed bit for bit.
+// show() hands the frame to a hook instead of a strip.
+
+#include <stdint.h>
+#include <string.h>
+
+typedef uint8_t fract8;
+
+// Defined by the sketch, blur2d maps coordinates through it like the real library does
+uint16_t XY(uint8_t x, uint8_t y);
+
+///////////////////////////////////////////////////////////////////////////////
+// 8 bit math
+
+inline uint8_t qadd8(uint8_t i, uint8_t j)
+{
+    unsigned int t = i + j;
+    return t > 255 ? 255 : t;
+}
+
+inline uint8_t qsub8(uint8_t i, uint8_t j)
+{
+    int t = i - j;
+    return t < 0 ? 0 : t;
+}
+
+inline uint8_t scale8(uint8_t i, fract8 scale)
+{
+    return (((uint16_t)i) * (1 + (uint16_t)(scale))) >> 8;
+}
+
+inline uint8_t scale8_video(uint8_t i, fract8 scale)
+{
+    return (((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+inline uint16_t scale16by8(uint16_t i, fract8 scale)
+{
+    return (i * (1 + ((uint16_t)scale))) >> 8;
+}
+
+inline uint8_t dim8_raw(uint8_t x) { return scale8(x, x); }
+
+inline uint8_t brighten8_raw(uint8_t x)
+{
+    uint8_t ix = 255 - x;
+    return 255 - scale8(ix, ix);
+}
+
+inline uint8_t map8(uint8_t in, uint8_t rangeStart, uint8_t rangeEnd)
+{
+    uint8_t rangeWidth = rangeEnd - rangeStart;
+    return rangeStart + scale8(in, rangeWidth);
+}
+
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB)
+{
+    uint16_t partial = (a << 8) | b;
+    partial += (b * amountOfB);
+    partial -= (a * amountOfB);
+    return partial >> 8;
+}
+
+inline uint8_t ease8InOutQuad(uint8_t i)
+{
+    uint8_t j = i;
+    if (j & 0x80)
+        j = 255 - j;
+    uint8_t jj = scale8(j, j);
+    uint8_t jj2 = jj << 1;
+    if (i & 0x80)
+        jj2 = 255 - jj2;
+    return jj2;
+}
+
+inline int8_t avg7(int8_t i, int8_t j)
+{
+    return (i >> 1) + (j >> 1) + (i & 0x1);
+}
+
+inline int8_t lerp7by8(int8_t a, int8_t b, fract8 frac)
+{
+    if (b > a)
+    {
+        uint8_t delta = b - a;
+        return a + scale8(delta, frac);
+    }
+    uint8_t delta = a - b;
+    return a - scale8(delta, frac);
+}
+
+// random16 and friends, the same LCG as FastLED so seeded sequences match
+inline uint16_t &rand16seed()
+{
+    static uint16_t seed = 1337;
+    return seed;
+}
+
+inline uint8_t random8()
+{
+    rand16seed() = (rand16seed() * 2053) + 13849;
+    return (uint8_t)(((uint8_t)(rand16seed() & 0xFF)) + ((uint8_t)(rand16seed() >> 8)));
+}
+
+inline uint16_t random16()
+{
+    rand16seed() = (rand16seed() * 2053) + 13849;
+    return rand16seed();
+}
+
+inline uint8_t random8(uint8_t lim) { return (random8() * lim) >> 8; }
+inline void random16_set_seed(uint16_t seed) { rand16seed() = seed; }
+inline void random16_add_entropy(uint16_t entropy) { rand16seed() += entropy; }
+
+///////////////////////////////////////////////////////////////////////////////
+// Colors
+
+typedef enum
+{
+    HUE_RED = 0,
+    HUE_ORANGE = 32,
+    HUE_YELLOW = 64,
+    HUE_GREEN = 96,
+    HUE_AQUA = 128,
+    HUE_BLUE = 160,
+    HUE_PURPLE = 192,
+    HUE_PINK = 224
+} HSVHue;
+
+struct CHSV
+{
+    uint8_t h, s, v;
+    CHSV() : h(0), s(0), v(0) {}
+    CHSV(uint8_t ih, uint8_t is, uint8_t iv) : h(ih), s(is), v(iv) {}
+};
+
+struct CRGB;
+void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb);
+
+struct CRGB
+{
+    uint8_t r, g, b;
+
+    enum HTMLColorCode : uint32_t
+    {
+        Black = 0x000000,
+        White = 0xFFFFFF,
+        Red = 0xFF0000,
+        Green = 0x008000,
+        Blue = 0x0000FF,
+    };
+
+    CRGB() : r(0), g(0), b(0) {}
+    constexpr CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    constexpr CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+    constexpr CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) {}
+    CRGB(const CHSV &hsv) { hsv2rgb_rainbow(hsv, *this); }
+
+    CRGB &operator=(const CHSV &hsv)
+    {
+        hsv2rgb_rainbow(hsv, *this);
+        return *this;
+    }
+
+    uint8_t &operator[](uint8_t x) { return (&r)[x]; }
+    const uint8_t &operator[](uint8_t x) const { return (&r)[x]; }
+
+    CRGB &operator+=(const CRGB &rhs)
+    {
+        r = qadd8(r, rhs.r);
+        g = qadd8(g, rhs.g);
+        b = qadd8(b, rhs.b);
+        return *this;
+    }
+
+    // per channel maximum
+    CRGB &operator|=(const CRGB &rhs)
+    {
+        if (rhs.r > r)
+            r = rhs.r;
+        if (rhs.g > g)
+            g = rhs.g;
+        if (rhs.b > b)
+            b = rhs.b;
+        return *this;
+    }
+
+    CRGB &operator>>=(uint8_t d)
+    {
+        r >>= d;
+        g >>= d;
+        b >>= d;
+        return *this;
+    }
+
+    CRGB &nscale8(uint8_t scaledown)
+    {
+        r = scale8(r, scaledown);
+        g = scale8(g, scaledown);
+        b = scale8(b, scaledown);
+        return *this;
+    }
+
+    CRGB &fadeToBlackBy(uint8_t fadefactor) { return nscale8(255 - fadefactor); }
+
+    uint8_t getLuma() const
+    {
+        return scale8(r, 54) + scale8(g, 183) + scale8(b, 18);
+    }
+
+    explicit operator bool() const { return r || g || b; }
+};
+
+inline bool operator==(const CRGB &a, const CRGB &b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+inline bool operator!=(const CRGB &a, const CRGB &b) { return !(a == b); }
+
+inline void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb)
+{
+    uint8_t hue = hsv.h;
+    uint8_t sat = hsv.s;
+    uint8_t val = hsv.v;
+
+    uint8_t offset = hue & 0x1F;
+    uint8_t offset8 = offset << 3;
+    uint8_t third = scale8(offset8, (256 / 3));
+    uint8_t r, g, b;
+
+    if (!(hue & 0x80))
+    {
+        if (!(hue & 0x40))
+        {
+            if (!(hue & 0x20))
+            {
+                r = 255 - third;
+                g = third;
+                b = 0;
+            }
+            else
+            {
+                r = 171;
+                g = 85 + third;
+                b = 0;
+            }
+        }
+        else
+        {
+            if (!(hue & 0x20))
+            {
+                uint8_t twothirds = scale8(offset8, ((256 * 2) / 3));
+                r = 171 - twothirds;
+                g = 170 + third;
+                b = 0;
+            }
+            else
+            {
+                r = 0;
+                g = 255 - third;
+                b = third;
+            }
+        }
+    }
+    else
+    {
+        if (!(hue & 0x40))
+        {
+            if (!(hue & 0x20))
+            {
+                r = 0;
+                uint8_t twothirds = scale8(offset8, ((256 * 2) / 3));
+                g = 171 - twothirds;
+                b = 85 + twothirds;
+            }
+            else
+            {
+                r = third;
+                g = 0;
+                b = 255 - third;
+            }
+        }
+        else
+        {
+            if (!(hue & 0x20))
+            {
+                r = 85 + third;
+                g = 0;
+                b = 171 - third;
+            }
+            else
+            {
+                r = 170 + third;
+                g = 0;
+                b = 85 - third;
+            }
+        }
+    }
+
+    if (sat != 255)
+    {
+        if (sat == 0)
+        {
+            r = 255;
+            b = 255;
+            g = 255;
+        }
+        else
+        {
+            uint8_t desat = 255 - sat;
+            desat = scale8_video(desat, desat);
+            uint8_t satscale = 255 - desat;
+            r = scale8(r, satscale);
+            g = scale8(g, satscale);
+            b = scale8(b, satscale);
+            uint8_t brightness_floor = desat;
+            r += brightness_floor;
+            g += brightness_floor;
+            b += brightness_floor;
+        }
+    }
+
+    if (val != 255)
+    {
+        val = scale8_video(val, val);
+        if (val == 0)
+        {
+            r = 0;
+            g = 0;
+            b = 0;
+        }
+        else
+        {
+            r = scale8(r, val);
+            g = scale8(g, val);
+            b = scale8(b, val);
+        }
+    }
+
+    rgb.r = r;
+    rgb.g = g;
+    rgb.b = b;
+}
+
+inline CRGB blend(const CRGB &p1, const CRGB &p2, fract8 amountOfP2)
+{
+    return CRGB(blend8(p1.r, p2.r, amountOfP2), blend8(p1.g, p2.g, amountOfP2), blend8(p1.b, p2.b, amountOfP2));
+}
+
+inline void fill_solid(CRGB *leds, int numToFill, const CRGB &color)
+{
+    for (int i = 0; i < numToFill; i++)
+        leds[i] = color;
+}
+
+inline void nscale8(CRGB *leds, uint16_t num_leds, uint8_t scale)
+{
+    for (uint16_t i = 0; i < num_leds; i++)
+        leds[i].nscale8(scale);
+}
+
+inline void fadeToBlackBy(CRGB *leds, uint16_t num_leds, uint8_t fadeBy)
+{
+    nscale8(leds, num_leds, 255 - fadeBy);
+}
+
+inline void fill_gradient_RGB(CRGB *leds, uint16_t startpos, CRGB startcolor, uint16_t endpos, CRGB endcolor)
+{
+    if (endpos < startpos)
+    {
+        uint16_t t = endpos;
+        CRGB tc = endcolor;
+        endcolor = startcolor;
+        endpos = startpos;
+        startpos = t;
+        startcolor = tc;
+    }
+
+    int16_t rdistance87 = (endcolor.r - startcolor.r) << 7;
+    int16_t gdistance87 = (endcolor.g - startcolor.g) << 7;
+    int16_t bdistance87 = (endcolor.b - startcolor.b) << 7;
+
+    uint16_t pixeldistance = endpos - startpos;
+    int16_t divisor = pixeldistance ? pixeldistance : 1;
+
+    int16_t rdelta87 = rdistance87 / divisor;
+    int16_t gdelta87 = gdistance87 / divisor;
+    int16_t bdelta87 = bdistance87 / divisor;
+
+    rdelta87 *= 2;
+    gdelta87 *= 2;
+    bdelta87 *= 2;
+
+    uint16_t r88 = startcolor.r << 8;
+    uint16_t g88 = startcolor.g << 8;
+    uint16_t b88 = startcolor.b << 8;
+    for (uint16_t i = startpos; i <= endpos; ++i)
+    {
+        leds[i] = CRGB(r88 >> 8, g88 >> 8, b88 >> 8);
+        r88 += rdelta87;
+        g88 += gdelta87;
+        b88 += bdelta87;
+    }
+}
+
+// 2D blur through the sketch's XY(), rows then columns
+inline void blurRows(CRGB *leds, uint8_t width, uint8_t height, fract8 blur_amount)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+    for (uint8_t row = 0; row < height; row++)
+    {
+        CRGB carryover = CRGB::Black;
+        for (uint8_t i = 0; i < width; i++)
+        {
+            CRGB cur = leds[XY(i, row)];
+            CRGB part = cur;
+            part.nscale8(seep);
+            cur.nscale8(keep);
+            cur += carryover;
+            if (i)
+                leds[XY(i - 1, row)] += part;
+            leds[XY(i, row)] = cur;
+            carryover = part;
+        }
+    }
+}
+
+inline void blurColumns(CRGB *leds, uint8_t width, uint8_t height, fract8 blur_amount)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+    for (uint8_t col = 0; col < width; ++col)
+    {
+        CRGB carryover = CRGB::Black;
+        for (uint8_t i = 0; i < height; ++i)
+        {
+            CRGB cur = leds[XY(col, i)];
+            CRGB part = cur;
+            part.nscale8(seep);
+            cur.nscale8(keep);
+            cur += carryover;
+            if (i)
+                leds[XY(col, i - 1)] += part;
+            leds[XY(col, i)] = cur;
+            carryover = part;
+        }
+    }
+}
+
+inline void blur2d(CRGB *leds, uint8_t width, uint8_t height, fract8 blur_amount)
+{
+    blurRows(leds, width, height, blur_amount);
+    blurColumns(leds, width, height, blur_amount);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Palettes
+
+typedef enum
+{
+    NOBLEND = 0,
+    LINEARBLEND = 1,
+    LINEARBLEND_NOWRAP = 2
+} TBlendType;
+
+typedef const uint8_t TProgmemRGBGradientPalette_byte;
+typedef const TProgmemRGBGradientPalette_byte *TProgmemRGBGradientPalette_bytes;
+
+#define DEFINE_GRADIENT_PALETTE(X) extern const TProgmemRGBGradientPalette_byte X[] =
+
+class CRGBPalette16
+{
+public:
+    CRGB entries[16];
+
+    CRGBPalette16() {}
+    CRGBPalette16(const CRGB &c)
+    {
+        fill_solid(entries, 16, c);
+    }
+    CRGBPalette16(CRGB::HTMLColorCode c) : CRGBPalette16(CRGB(c)) {}
+
+    // Expands a gradient of (index, r, g, b) anchors ending at index 255 into 16 entries
+    CRGBPalette16(TProgmemRGBGradientPalette_bytes progpal)
+    {
+        uint16_t count = 0;
+        while (progpal[count * 4] != 255)
+            count++;
+        count++;
+
+        int8_t lastSlotUsed = -1;
+        const uint8_t *progent = progpal;
+        CRGB rgbstart(progent[1], progent[2], progent[3]);
+        int indexstart = 0;
+        while (indexstart < 255)
+        {
+            progent += 4;
+            int indexend = progent[0];
+            CRGB rgbend(progent[1], progent[2], progent[3]);
+            uint8_t istart8 = indexstart / 16;
+            uint8_t iend8 = indexend / 16;
+            if (count < 16)
+            {
+                if ((istart8 <= lastSlotUsed) && (lastSlotUsed < 15))
+                {
+                    istart8 = lastSlotUsed + 1;
+                    if (iend8 < istart8)
+                        iend8 = istart8;
+                }
+                lastSlotUsed = iend8;
+            }
+            fill_gradient_RGB(entries, istart8, rgbstart, iend8, rgbend);
+            indexstart = indexend;
+            rgbstart = rgbend;
+        }
+    }
+
+    CRGB &operator[](uint8_t x) { return entries[x]; }
+    const CRGB &operator[](uint8_t x) const { return entries[x]; }
+};
+
+inline CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND)
+{
+    if (blendType == LINEARBLEND_NOWRAP)
+    {
+        index = map8(index, 0, 239);
+    }
+
+    uint8_t hi4 = index >> 4;
+    uint8_t lo4 = index & 0x0F;
+    const CRGB *entry = &(pal.entries[0]) + hi4;
+
+    uint8_t red1 = entry->r;
+    uint8_t green1 = entry->g;
+    uint8_t blue1 = entry->b;
+
+    if (lo4 && (blendType != NOBLEND))
+    {
+        entry = hi4 == 15 ? &(pal.entries[0]) : entry + 1;
+        uint8_t f2 = lo4 << 4;
+        uint8_t f1 = 255 - f2;
+        red1 = scale8(red1, f1) + scale8(entry->r, f2);
+        green1 = scale8(green1, f1) + scale8(entry->g, f2);
+        blue1 = scale8(blue1, f1) + scale8(entry->b, f2);
+    }
+
+    if (brightness != 255)
+    {
+        if (brightness)
+        {
+            ++brightness;
+            red1 = scale8(red1, brightness);
+            green1 = scale8(green1, brightness);
+            blue1 = scale8(blue1, brightness);
+        }
+        else
+        {
+            red1 = 0;
+            green1 = 0;
+            blue1 = 0;
+        }
+    }
+
+    return CRGB(red1, green1, blue1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Noise
+
+namespace HostNoise
+{
+    // Ken Perlin's permutation, repeated once so P(x + 1) never needs wrapping
+    static const uint8_t p[] = {
+        151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225, 140, 36, 103, 30, 69, 142,
+        8, 99, 37, 240, 21, 10, 23, 190, 6, 148, 247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117,
+        35, 11, 32, 57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175, 74, 165, 71,
+        134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122, 60, 211, 133, 230, 220, 105, 92, 41,
+        55, 46, 245, 40, 244, 102, 143, 54, 65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89,
+        18, 169, 200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64, 52, 217, 226,
+        250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212, 207, 206, 59, 227, 47, 16, 58, 17, 182,
+        189, 28, 42, 223, 183, 170, 213, 119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43,
+        172, 9, 129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104, 218, 246, 97,
+        228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241, 81, 51, 145, 235, 249, 14, 239,
+        107, 49, 192, 214, 31, 181, 199, 106, 157, 184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254,
+        138, 236, 205, 93, 222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180, 151};
+
+    inline uint8_t P(uint8_t x) { return p[x]; }
+
+    inline int8_t grad8(uint8_t hash, int8_t x, int8_t y, int8_t z)
+    {
+        hash = hash & 0xF;
+        int8_t u = (hash & 8) ? y : x;
+        int8_t v = hash < 4 ? y : hash == 12 || hash == 14 ? x
+                                                           : z;
+        if (hash & 1)
+            u = -u;
+        if (hash & 2)
+            v = -v;
+        return avg7(u, v);
+    }
+}
+
+inline int8_t inoise8_raw(uint16_t x, uint16_t y, uint16_t z)
+{
+    using HostNoise::grad8;
+    using HostNoise::P;
+
+    uint8_t X = x >> 8;
+    uint8_t Y = y >> 8;
+    uint8_t Z = z >> 8;
+
+    uint8_t A = P(X) + Y;
+    uint8_t AA = P(A) + Z;
+    uint8_t AB = P(A + 1) + Z;
+    uint8_t B = P(X + 1) + Y;
+    uint8_t BA = P(B) + Z;
+    uint8_t BB = P(B + 1) + Z;
+
+    uint8_t u = ease8InOutQuad(x);
+    uint8_t v = ease8InOutQuad(y);
+    uint8_t w = ease8InOutQuad(z);
+
+    int8_t xx = ((uint8_t)(x) >> 1) & 0x7F;
+    int8_t yy = ((uint8_t)(y) >> 1) & 0x7F;
+    int8_t zz = ((uint8_t)(z) >> 1) & 0x7F;
+    const uint8_t N = 0x80;
+
+    int8_t X1 = lerp7by8(grad8(P(AA), xx, yy, zz), grad8(P(BA), xx - N, yy, zz), u);
+    int8_t X2 = lerp7by8(grad8(P(AB), xx, yy - N, zz), grad8(P(BB), xx - N, yy - N, zz), u);
+    int8_t X3 = lerp7by8(grad8(P(AA + 1), xx, yy, zz - N), grad8(P(BA + 1), xx - N, yy, zz - N), u);
+    int8_t X4 = lerp7by8(grad8(P(AB + 1), xx, yy - N, zz - N), grad8(P(BB + 1), xx - N, yy - N, zz - N), u);
+
+    int8_t Y1 = lerp7by8(X1, X2, v);
+    int8_t Y2 = lerp7by8(X3, X4, v);
+
+    return lerp7by8(Y1, Y2, w);
+}
+
+inline uint8_t inoise8(uint16_t x, uint16_t y, uint16_t z)
+{
+    int8_t n = inoise8_raw(x, y, z); // -64..+64
+    n += 64;                         //   0..128
+    return qadd8(n, n);              //   0..255
+}
+
+inline void fill_raw_2dnoise8(uint8_t *pData, int width, int height, uint8_t octaves, uint8_t freq, fract8 amplitude, int skip,
+                              uint16_t x, int scalex, uint16_t y, int scaley, uint16_t time)
+{
+    if (octaves > 1)
+    {
+        fill_raw_2dnoise8(pData, width, height, octaves - 1, freq, amplitude, skip + 1, x * freq, freq * scalex, y * freq, freq * scaley, time);
+    }
+    else
+    {
+        // amplitude is always 255 on the lowest level
+        amplitude = 255;
+    }
+
+    scalex *= skip;
+    scaley *= skip;
+
+    fract8 invamp = 255 - amplitude;
+    for (int i = 0; i < height; ++i, y += scaley)
+    {
+        uint16_t xx = x;
+        for (int j = 0; j < width; ++j, xx += scalex)
+        {
+            uint8_t noise_base = inoise8(xx, y, time);
+            noise_base = (0x80 & noise_base) ? (noise_base - 127) : (127 - noise_base);
+            noise_base = scale8(noise_base << 1, amplitude);
+            for (int ii = i; ii < (i + skip) && ii < height; ++ii)
+            {
+                uint8_t *pRow = pData + (ii * width);
+                for (int jj = j; jj < (j + skip) && jj < width; ++jj)
+                {
+                    pRow[jj] = scale8(pRow[jj], invamp) + noise_base;
+                }
+            }
+        }
+    }
+}
+
+inline void fill_raw_2dnoise8(uint8_t *pData, int width, int height, uint8_t octaves, uint16_t x, int scalex, uint16_t y, int scaley, uint16_t time)
+{
+    // FastLED passes a q4.4 frequency of 2 and half amplitude for the upper octaves
+    fill_raw_2dnoise8(pData, width, height, octaves, 2, 128, 1, x, scalex, y, scaley, time);
+}
+
+inline void fill_2dnoise8(CRGB *leds, int width, int height, bool serpentine,
+                          uint8_t octaves, uint16_t x, int xscale, uint16_t y, int yscale, uint16_t time,
+                          uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,
+                          uint16_t hue_time, bool blend)
+{
+    uint8_t V[height][width];
+    uint8_t H[height][width];
+
+    memset(V, 0, height * width);
+    memset(H, 0, height * width);
+
+    fill_raw_2dnoise8((uint8_t *)V, width, height, octaves, x, xscale, y, yscale, time);
+    fill_raw_2dnoise8((uint8_t *)H, width, height, hue_octaves, hue_x, hue_xscale, hue_y, hue_yscale, hue_time);
+
+    int w1 = width - 1;
+    int h1 = height - 1;
+    for (int i = 0; i < height; ++i)
+    {
+        int wb = i * width;
+        for (int j = 0; j < width; ++j)
+        {
+            CRGB led(CHSV(H[h1 - i][w1 - j], 255, V[i][j]));
+
+            int pos = j;
+            if (serpentine && (i & 0x1))
+                pos = w1 - j;
+
+            if (blend)
+            {
+                leds[wb + pos] >>= 1;
+                leds[wb + pos] += (led >>= 1);
+            }
+            else
+            {
+                leds[wb + pos] = led;
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Pixel sets
+
+// A window onto a pixel array, like FastLED's CRGBSet. Ranges taken with operator() are inclusive.
+template <class PIXEL_TYPE>
+class CPixelView
+{
+public:
+    PIXEL_TYPE *const leds;
+    const int len;
+
+    CPixelView(PIXEL_TYPE *_leds, int _len) : leds(_leds), len(_len) {}
+
+    PIXEL_TYPE &operator[](int x) const { return leds[x]; }
+
+    CPixelView operator()(int start, int end) const { return CPixelView(leds + start, end - start + 1); }
+
+    CPixelView &operator=(const PIXEL_TYPE &color)
+    {
+        for (int i = 0; i < len; i++)
+            leds[i] = color;
+        return *this;
+    }
+
+    int size() const { return len; }
+
+    operator PIXEL_TYPE *() const { return leds; }
+};
+
+typedef CPixelView<CRGB> CRGBSet;
+
+///////////////////////////////////////////////////////////////////////////////
+// Controller
+
+enum LEDColorCorrection : uint32_t
+{
+    TypicalLEDStrip = 0xFFB0F0,
+    UncorrectedColor = 0xFFFFFF
+};
+
+enum ColorTemperature : uint32_t
+{
+    Candle = 0xFF9329,
+    UncorrectedTemperature = 0xFFFFFF
+};
+
+enum EOrder
+{
+    RGB = 0012,
+    GRB = 0102
+};
+
+class WS2812B
+{
+};
+
+// Records the registered strip and the brightness, show() passes the frame to onShow if set
+class CFastLED
+{
+public:
+    template <typename Chipset, uint8_t Pin, EOrder Order>
+    CFastLED &addLeds(CRGB *data, int nLeds)
+    {
+        leds = data;
+        size = nLeds;
+        return *this;
+    }
+
+    void setCorrection(LEDColorCorrection correction) {}
+    void setTemperature(ColorTemperature temperature) {}
+    void setDither(uint8_t dither) {}
+    void setBrightness(uint8_t scale) { brightness = scale; }
+    uint8_t getBrightness() { return brightness; }
+
+    void show()
+    {
+        if (onShow && leds)
+            onShow(leds, size, brightness);
+    }
+
+    void (*onShow)(const CRGB *leds, int size, uint8_t brightness) = nullptr;
+
+private:
+    CRGB *leds = nullptr;
+    int size = 0;
+    uint8_t brightness = 255;
+};
+
+inline CFastLED FastLED;
+
+#endif // HOST_FASTLED_H
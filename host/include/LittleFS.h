@@ -0,0 +1,108 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+// LittleFS stand-in over a host directory, ./littlefs unless the host picks another root.
+// Files are byte streams with the Arduino Stream calls ArduinoJson reads and writes through.
+
+#include "Arduino.h"
+#include <string>
+
+class File
+{
+public:
+    File(FILE *file = nullptr) : file(file) {}
+
+    operator bool() const { return file != nullptr; }
+
+    int available()
+    {
+        if (!file)
+            return 0;
+        int c = fgetc(file);
+        if (c == EOF)
+            return 0;
+        ungetc(c, file);
+        return 1;
+    }
+
+    int read() { return file ? fgetc(file) : -1; }
+
+    int peek()
+    {
+        int c = read();
+        if (c != EOF)
+            ungetc(c, file);
+        return c;
+    }
+
+    size_t readBytes(char *buffer, size_t size) { return file ? fread(buffer, 1, size, file) : 0; }
+    size_t read(uint8_t *buffer, size_t size) { return readBytes(reinterpret_cast<char *>(buffer), size); }
+
+    size_t write(uint8_t value) { return file && fputc(value, file) != EOF ? 1 : 0; }
+    size_t write(const uint8_t *data, size_t size) { return file ? fwrite(data, 1, size, file) : 0; }
+
+    size_t size()
+    {
+        if (!file)
+            return 0;
+        long position = ftell(file);
+        fseek(file, 0, SEEK_END);
+        long end = ftell(file);
+        fseek(file, position, SEEK_SET);
+        return end;
+    }
+
+    void flush()
+    {
+        if (file)
+            fflush(file);
+    }
+
+    void close()
+    {
+        if (file)
+            fclose(file);
+        file = nullptr;
+    }
+
+private:
+    FILE *file;
+};
+
+class HostLittleFS
+{
+public:
+    bool begin(bool formatOnFail = false) { return true; }
+    void end() {}
+
+    // Where the files live on the host, paths given to open are relative to it
+    void SetRoot(const char *path) { root = path; }
+
+    File open(const char *path, const char *mode = "r", bool create = false)
+    {
+        std::string full = root + (path[0] == '/' ? "" : "/") + path;
+        const char *host_mode = mode[0] == 'w' ? "wb" : mode[0] == 'a' ? "ab" : "rb";
+        return File(fopen(full.c_str(), host_mode));
+    }
+
+    bool exists(const char *path)
+    {
+        File file = open(path);
+        bool found = file;
+        file.close();
+        return found;
+    }
+
+    bool remove(const char *path)
+    {
+        std::string full = root + (path[0] == '/' ? "" : "/") + path;
+        return ::remove(full.c_str()) == 0;
+    }
+
+private:
+    std::string root = "littlefs";
+};
+
+inline HostLittleFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
@@ -0,0 +1,105 @@
+#ifndef HOST_DRIVER_TOUCH_SENSOR_H
+#define HOST_DRIVER_TOUCH_SENSOR_H
+
+// Touch sensor driver stand-in. The host sets the raw value latched for each channel and calls
+// HostTouch::Scan() to signal a finished FSM scan, which runs the scan done interrupt.
+
+#include "../Arduino.h"
+
+typedef enum
+{
+    TOUCH_PAD_NUM0 = 0,
+    TOUCH_PAD_MAX = 15,
+} touch_pad_t;
+
+typedef enum
+{
+    TOUCH_HVOLT_2V7 = 3,
+} touch_high_volt_t;
+
+typedef enum
+{
+    TOUCH_LVOLT_0V5 = 0,
+} touch_low_volt_t;
+
+typedef enum
+{
+    TOUCH_HVOLT_ATTEN_0V5 = 2,
+} touch_volt_atten_t;
+
+typedef enum
+{
+    TOUCH_PAD_IDLE_CH_CONNECT_DEFAULT = 1,
+} touch_pad_conn_type_t;
+
+typedef enum
+{
+    TOUCH_FSM_MODE_TIMER = 0,
+    TOUCH_FSM_MODE_SW,
+} touch_fsm_mode_t;
+
+#define TOUCH_PAD_INTR_MASK_SCAN_DONE (1 << 4)
+
+typedef void (*intr_handler_t)(void *arg);
+
+namespace HostTouch
+{
+    struct State
+    {
+        uint32_t raw[TOUCH_PAD_MAX] = {};
+        intr_handler_t isr = nullptr;
+        void *arg = nullptr;
+        bool enabled = false;
+    };
+
+    inline State &Get()
+    {
+        static State state;
+        return state;
+    }
+
+    inline void Set(uint8_t channel, uint32_t raw)
+    {
+        if (channel < TOUCH_PAD_MAX)
+            Get().raw[channel] = raw;
+    }
+
+    // The FSM finished a scan, the values set since the previous one are latched
+    inline void Scan()
+    {
+        State &state = Get();
+        if (state.isr && state.enabled)
+            state.isr(state.arg);
+    }
+}
+
+inline esp_err_t touch_pad_init() { return ESP_OK; }
+inline esp_err_t touch_pad_config(touch_pad_t channel) { return ESP_OK; }
+inline esp_err_t touch_pad_set_meas_time(uint16_t sleep, uint16_t measure) { return ESP_OK; }
+inline esp_err_t touch_pad_set_voltage(touch_high_volt_t high, touch_low_volt_t low, touch_volt_atten_t atten) { return ESP_OK; }
+inline esp_err_t touch_pad_set_idle_channel_connect(touch_pad_conn_type_t type) { return ESP_OK; }
+inline esp_err_t touch_pad_set_fsm_mode(touch_fsm_mode_t mode) { return ESP_OK; }
+inline esp_err_t touch_pad_fsm_start() { return ESP_OK; }
+
+inline esp_err_t touch_pad_read_raw_data(touch_pad_t channel, uint32_t *value)
+{
+    if (channel >= TOUCH_PAD_MAX)
+        return ESP_FAIL;
+    *value = HostTouch::Get().raw[channel];
+    return ESP_OK;
+}
+
+inline esp_err_t touch_pad_isr_register(intr_handler_t isr, void *arg, int mask)
+{
+    HostTouch::Get().isr = isr;
+    HostTouch::Get().arg = arg;
+    return ESP_OK;
+}
+
+inline esp_err_t touch_pad_intr_enable(int mask)
+{
+    HostTouch::Get().enabled = true;
+    return ESP_OK;
+}
+
+#endif // HOST_DRIVER_TOUCH_SENSOR_H
@@ -0,0 +1,13 @@
+#ifndef HOST_ESP_FREERTOS_HOOKS_H
+#define HOST_ESP_FREERTOS_HOOKS_H
+
+// No idle task on the host, hooks are accepted and never called
+
+#include "Arduino.h"
+
+typedef bool (*esp_freertos_idle_cb_t)();
+
+inline esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb, int cpuid) { return ESP_OK; }
+inline void esp_deregister_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb, int cpuid) {}
+
+#endif // HOST_ESP_FREERTOS_HOOKS_H
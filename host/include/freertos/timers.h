@@ -0,0 +1,119 @@
+#ifndef HOST_FREERTOS_TIMERS_H
+#define HOST_FREERTOS_TIMERS_H
+
+// Software timers on the virtual clock. Nothing fires on its own: the host calls HostTimers::Run()
+// after moving the clock and every expired timer runs its callback, in expiry order, like the timer
+// service task would.
+
+#include "../Arduino.h"
+
+struct HostTimer;
+typedef HostTimer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+struct HostTimer
+{
+    const char *name;
+    TickType_t period;
+    bool reload;
+    void *id;
+    TimerCallbackFunction_t callback;
+    bool active = false;
+    ulong expiry = 0; // ms
+};
+
+namespace HostTimers
+{
+    inline std::vector<HostTimer *> &All()
+    {
+        static std::vector<HostTimer *> timers;
+        return timers;
+    }
+
+    inline void Arm(HostTimer *timer)
+    {
+        timer->active = true;
+        timer->expiry = millis() + timer->period;
+    }
+
+    // Runs the callbacks of the expired timers, returns how many ran
+    inline uint32_t Run()
+    {
+        uint32_t fired = 0;
+        while (1)
+        {
+            HostTimer *next = nullptr;
+            for (HostTimer *timer : All())
+            {
+                if (timer->active && timer->expiry <= millis() && (!next || timer->expiry < next->expiry))
+                    next = timer;
+            }
+            if (!next)
+                return fired;
+            if (next->reload)
+                next->expiry += next->period;
+            else
+                next->active = false;
+            next->callback(next);
+            fired++;
+        }
+    }
+
+    // ms until the next timer expires, UINT32_MAX when none is running
+    inline uint32_t NextExpiry()
+    {
+        uint32_t next = UINT32_MAX;
+        for (HostTimer *timer : All())
+        {
+            if (timer->active)
+                next = min<uint32_t>(next, timer->expiry > millis() ? timer->expiry - millis() : 0);
+        }
+        return next;
+    }
+
+    inline void Clear()
+    {
+        for (HostTimer *timer : All())
+            delete timer;
+        All().clear();
+    }
+}
+
+inline TimerHandle_t xTimerCreate(const char *name, TickType_t period, BaseType_t reload, void *id, TimerCallbackFunction_t callback)
+{
+    HostTimer *timer = new HostTimer{name, period, reload == pdTRUE, id, callback};
+    HostTimers::All().push_back(timer);
+    return timer;
+}
+
+inline BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait)
+{
+    HostTimers::Arm(timer);
+    return pdPASS;
+}
+
+inline BaseType_t xTimerReset(TimerHandle_t timer, TickType_t wait) { return xTimerStart(timer, wait); }
+
+inline BaseType_t xTimerResetFromISR(TimerHandle_t timer, BaseType_t *woken)
+{
+    if (woken)
+        *woken = pdFALSE;
+    return xTimerStart(timer, 0);
+}
+
+inline BaseType_t xTimerStop(TimerHandle_t timer, TickType_t wait)
+{
+    timer->active = false;
+    return pdPASS;
+}
+
+inline BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t wait)
+{
+    timer->period = period;
+    return xTimerStart(timer, wait);
+}
+
+inline BaseType_t xTimerIsTimerActive(TimerHandle_t timer) { return timer->active ? pdTRUE : pdFALSE; }
+inline void *pvTimerGetTimerID(TimerHandle_t timer) { return timer->id; }
+
+#endif // HOST_FREERTOS_TIMERS_H
@@ -0,0 +1,13 @@
+#ifndef HOST_BLEMIDI_ESP32_NIMBLE_H
+#define HOST_BLEMIDI_ESP32_NIMBLE_H
+
+// NimBLE backend tag, the host transport in BLEMIDI_Transport.h does not use it
+
+namespace bleMidi
+{
+    class BLEMIDI_ESP32_NimBLE
+    {
+    };
+}
+
+#endif // HOST_BLEMIDI_ESP32_NIMBLE_H
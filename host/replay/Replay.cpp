@@ -0,0 +1,755 @@
+// Replays sensor traces through the firmware on the host, against the stand-ins in host/include.
+//
+//   replay <trace> [--text out.txt] [--smf out.mid] [--golden file.txt [--record]] [--config file.json]
+//                  [--repeat n] [--serial] [--log]
+//
+// The whole firmware runs: main.cpp is built into this file, setup() once, then loop() and the work of the
+// ADC, slider and touch scan tasks interleaved on a virtual clock, the way the tasks share the device.
+// Inputs only depend on the trace and the clock, so the same trace always gives the same MIDI, byte for
+// byte, and as fast as the host can go.
+// --golden compares the text log with one recorded earlier with --record and fails on any difference.
+// What the firmware allocates is counted into ESP.getFreeHeap(), the run fails when the heap held at the end
+// of the last repeat is more than at the end of the first, so a soak run with --repeat catches leaks.
+
+#include "main.cpp"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <new>
+#include <cstddef>
+
+#define REPLAY_ADC_US 15      // one conversion, the ADC task converts back to back
+#define REPLAY_LOOP_US 200    // loop() period
+#define REPLAY_SCAN_US 4000   // touch FSM scan period for the 7 pads
+#define REPLAY_CAL_MIN 2584   // ADC counts of a key pressed down, Adc's default calibration
+#define REPLAY_CAL_MAX 3770   // ADC counts of a key at rest
+#define REPLAY_PAD_BASE 30000 // raw touch value of an untouched pad
+#define REPLAY_FINGER 40000   // raw touch delta of a full finger right over a pad
+#define REPLAY_FINGER_WIDTH 1.5f // pads from the finger's center to where it no longer counts
+
+// A value over time, straight lines between the points. Reads must go forward in time.
+class Track
+{
+public:
+    void Add(uint64_t time, float value) { points.push_back({time, value}); }
+
+    float At(uint64_t time)
+    {
+        if (points.empty())
+            return 0.0f;
+        while (cursor + 1 < points.size() && points[cursor + 1].time <= time)
+            cursor++;
+        const Point &a = points[cursor];
+        if (time <= a.time || cursor + 1 == points.size())
+            return cursor == 0 && time < a.time ? 0.0f : a.value;
+        const Point &b = points[cursor + 1];
+        return a.value + (b.value - a.value) * (float)(time - a.time) / (float)(b.time - a.time);
+    }
+
+private:
+    struct Point
+    {
+        uint64_t time; // us
+        float value;
+    };
+    std::vector<Point> points;
+    size_t cursor = 0;
+};
+
+// Finger on the slider. Positions slide from one point to the next, lifting and landing are instant.
+class SliderTrack
+{
+public:
+    void Add(uint64_t time, float position, float strength) { points.push_back({time, position, strength}); }
+
+    float At(uint64_t time, float &strength)
+    {
+        strength = 0.0f;
+        if (points.empty() || time < points[0].time)
+            return 0.0f;
+        while (cursor + 1 < points.size() && points[cursor + 1].time <= time)
+            cursor++;
+        const Point &a = points[cursor];
+        strength = a.strength;
+        if (cursor + 1 == points.size() || a.strength == 0.0f || points[cursor + 1].strength == 0.0f)
+            return a.position;
+        const Point &b = points[cursor + 1];
+        return a.position + (b.position - a.position) * (float)(time - a.time) / (float)(b.time - a.time);
+    }
+
+private:
+    struct Point
+    {
+        uint64_t time; // us
+        float position, strength;
+    };
+    std::vector<Point> points;
+    size_t cursor = 0;
+};
+
+struct ButtonEvent
+{
+    uint64_t time; // us
+    uint8_t pin;
+    bool down;
+};
+
+// A trace is a text file of timed inputs, one per line, `<ms> <input> [args]`, # starts a comment:
+//
+//   key <n> <depth>      key n (0-15, left to right, top to bottom) pressed down to depth, 0 at rest to 1
+//   adc <n> <counts>     same as key with the raw ADC counts of a recording
+//   slider <pos> [s]     finger on the slider at pos, 0 to 1, strength s (1 by default)
+//   slider off           finger lifted
+//   pad <n> <delta>      raw touch delta of pad n (0-6) over the untouched value, adds to the finger
+//   button <touch|mode> <down|up>
+//   end                  stop here, one second after the last input otherwise
+//
+// Keys and pads ramp linearly from one point to the next of the same input, so a press is a few points.
+class Trace
+{
+public:
+    Track keys[Matrix::SIZE];
+    Track pads[NUM_SENSORS];
+    SliderTrack slider;
+    std::vector<ButtonEvent> buttons;
+    uint64_t duration = 0; // us
+    uint64_t period = 0;   // us, of one repeat
+
+    bool Load(const char *path, uint32_t repeat)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            fprintf(stderr, "can't open trace %s\n", path);
+            return false;
+        }
+        std::vector<std::string> lines;
+        std::string text;
+        while (std::getline(file, text))
+            lines.push_back(text);
+
+        uint64_t end = 0, last = 0;
+        for (int pass = 0; pass < 2; pass++)
+        {
+            // the first pass only finds the length, the repeats are laid end to end
+            for (uint32_t r = 0; r < (pass == 0 ? 1 : repeat); r++)
+            {
+                for (size_t i = 0; i < lines.size(); i++)
+                {
+                    if (!Parse(lines[i], i + 1, r * end, pass == 1, last, end))
+                        return false;
+                }
+            }
+            if (pass == 0 && end == 0)
+                end = last + 1000000;
+        }
+        period = end;
+        duration = end * repeat;
+        return true;
+    }
+
+private:
+    bool Parse(std::string text, int line, uint64_t offset, bool store, uint64_t &last, uint64_t &end)
+    {
+        size_t comment = text.find('#');
+        if (comment != std::string::npos)
+            text.erase(comment);
+        std::istringstream words(text);
+        double ms;
+        std::string input;
+        if (!(words >> ms >> input))
+            return true;
+        uint64_t time = offset + (uint64_t)(ms * 1000.0);
+        std::string a0, a1;
+        words >> a0 >> a1;
+
+        if (!store)
+        {
+            if (input == "end")
+                end = time;
+            last = max(last, time);
+            return true;
+        }
+
+        if (input == "key" || input == "adc")
+        {
+            int n = atoi(a0.c_str());
+            float value = atof(a1.c_str());
+            if (n < 0 || n >= Matrix::SIZE || a1.empty())
+                return Error(line, "bad key");
+            keys[n].Add(time, input == "key" ? value : (REPLAY_CAL_MAX - value) / (REPLAY_CAL_MAX - REPLAY_CAL_MIN));
+        }
+        else if (input == "slider")
+        {
+            if (a0 == "off")
+                slider.Add(time, 0.0f, 0.0f);
+            else
+                slider.Add(time, atof(a0.c_str()), a1.empty() ? 1.0f : atof(a1.c_str()));
+        }
+        else if (input == "pad")
+        {
+            int n = atoi(a0.c_str());
+            if (n < 0 || n >= NUM_SENSORS || a1.empty())
+                return Error(line, "bad pad");
+            pads[n].Add(time, atof(a1.c_str()));
+        }
+        else if (input == "button")
+        {
+            if ((a0 != "touch" && a0 != "mode") || (a1 != "down" && a1 != "up"))
+                return Error(line, "bad button");
+            buttons.push_back({time, (uint8_t)(a0 == "touch" ? PIN_TOUCH : PIN_MODE), a1 == "down"});
+        }
+        else if (input != "end")
+            return Error(line, "unknown input");
+        return true;
+    }
+
+    static bool Error(int line, const char *message)
+    {
+        fprintf(stderr, "line %d: %s\n", line, message);
+        return false;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Heap the firmware holds, the replay's own allocations are left out. Every block carries its size and
+// whether it was counted, so the replay can free what the firmware allocated and the other way around.
+bool count_heap = false;
+
+struct alignas(std::max_align_t) HeapHeader
+{
+    size_t size;
+    bool counted;
+};
+
+void *operator new(size_t size)
+{
+    HeapHeader *header = static_cast<HeapHeader *>(malloc(sizeof(HeapHeader) + size));
+    if (!header)
+        throw std::bad_alloc();
+    header->size = size;
+    header->counted = count_heap;
+    if (count_heap)
+    {
+        HostHeap::Used() += size;
+        HostHeap::Allocations()++;
+    }
+    return header + 1;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *block) noexcept
+{
+    if (!block)
+        return;
+    HeapHeader *header = static_cast<HeapHeader *>(block) - 1;
+    if (header->counted)
+        HostHeap::Used() -= header->size;
+    free(header);
+}
+
+void operator delete[](void *block) noexcept { operator delete(block); }
+void operator delete(void *block, size_t size) noexcept { operator delete(block); }
+void operator delete[](void *block, size_t size) noexcept { operator delete(block); }
+
+// Counts the heap while the firmware runs
+class FirmwareHeap
+{
+public:
+    FirmwareHeap() { count_heap = true; }
+    ~FirmwareHeap() { count_heap = false; }
+};
+
+struct HeapSample
+{
+    size_t used;        // bytes held
+    size_t allocations; // so far
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct MidiMessage
+{
+    uint64_t time; // us
+    uint8_t port;
+    std::vector<uint8_t> bytes;
+};
+
+enum Port
+{
+    USB,
+    BLE,
+    UART,
+    PORT_AMOUNT
+};
+
+const char *port_names[PORT_AMOUNT] = {"usb", "ble", "uart"};
+
+// Splits what a transport wrote into messages, running status included
+class MidiParser
+{
+public:
+    void Feed(std::vector<uint8_t> &bytes, uint8_t port, std::vector<MidiMessage> &out)
+    {
+        for (uint8_t value : bytes)
+        {
+            if (value >= 0xF8)
+            {
+                out.push_back({micros(), port, {value}});
+                continue;
+            }
+            if (value & 0x80)
+            {
+                if (sysex && value == 0xF7)
+                {
+                    message.push_back(value);
+                    out.push_back({micros(), port, message});
+                    sysex = false;
+                    continue;
+                }
+                sysex = value == 0xF0;
+                status = value < 0xF0 ? value : 0;
+                message.assign(1, value);
+            }
+            else if (!sysex)
+            {
+                if (message.empty() && status)
+                    message.assign(1, status);
+                if (message.empty())
+                    continue; // data without a status
+                message.push_back(value);
+            }
+            else
+            {
+                message.push_back(value);
+                continue;
+            }
+
+            if (!sysex && !message.empty() && message.size() == Length(message[0]))
+            {
+                out.push_back({micros(), port, message});
+                message.clear();
+            }
+        }
+        bytes.clear();
+    }
+
+private:
+    std::vector<uint8_t> message;
+    uint8_t status = 0;
+    bool sysex = false;
+
+    static size_t Length(uint8_t status)
+    {
+        switch (status & 0xF0)
+        {
+        case 0xC0:
+        case 0xD0:
+            return 2;
+        case 0xF0:
+            return status == 0xF1 || status == 0xF3 ? 2 : status == 0xF2 ? 3 : 1;
+        default:
+            return 3;
+        }
+    }
+};
+
+std::string Describe(const MidiMessage &message)
+{
+    char text[96];
+    const std::vector<uint8_t> &m = message.bytes;
+    int length = snprintf(text, sizeof(text), "%llu.%03llu %s ", (unsigned long long)(message.time / 1000),
+                          (unsigned long long)(message.time % 1000), port_names[message.port]);
+    char *out = text + length;
+    size_t size = sizeof(text) - length;
+    uint8_t channel = (m[0] & 0x0F) + 1;
+    switch (m[0] & 0xF0)
+    {
+    case 0x80:
+        snprintf(out, size, "note_off %u %u %u", channel, m[1], m[2]);
+        break;
+    case 0x90:
+        snprintf(out, size, "note_on %u %u %u", channel, m[1], m[2]);
+        break;
+    case 0xA0:
+        snprintf(out, size, "poly_at %u %u %u", channel, m[1], m[2]);
+        break;
+    case 0xB0:
+        snprintf(out, size, "cc %u %u %u", channel, m[1], m[2]);
+        break;
+    case 0xC0:
+        snprintf(out, size, "program %u %u", channel, m[1]);
+        break;
+    case 0xD0:
+        snprintf(out, size, "channel_at %u %u", channel, m[1]);
+        break;
+    case 0xE0:
+        snprintf(out, size, "bend %u %d", channel, (m[1] | (m[2] << 7)) - 8192);
+        break;
+    default:
+        if (m[0] == 0xF0)
+            snprintf(out, size, "sysex %zu", m.size());
+        else
+            snprintf(out, size, "system %02x", m[0]);
+        break;
+    }
+    return text;
+}
+
+// Type 1, a tempo track then a track per port that sent anything, a tick is a millisecond
+bool WriteSmf(const char *path, const std::vector<MidiMessage> &messages)
+{
+    auto varlen = [](std::vector<uint8_t> &out, uint32_t value)
+    {
+        uint8_t bytes[5];
+        int count = 0;
+        do
+        {
+            bytes[count++] = value & 0x7F;
+            value >>= 7;
+        } while (value);
+        while (count--)
+            out.push_back(bytes[count] | (count ? 0x80 : 0));
+    };
+
+    std::vector<std::vector<uint8_t>> tracks;
+    tracks.push_back({0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20}); // 500000 us per quarter
+    for (uint8_t port = 0; port < PORT_AMOUNT; port++)
+    {
+        std::vector<uint8_t> track;
+        uint64_t last = 0;
+        for (const MidiMessage &message : messages)
+        {
+            if (message.port != port || message.bytes[0] >= 0xF8)
+                continue;
+            if (track.empty())
+            {
+                uint8_t length = strlen(port_names[port]);
+                track.insert(track.end(), {0x00, 0xFF, 0x03, length});
+                track.insert(track.end(), port_names[port], port_names[port] + length);
+            }
+            uint64_t tick = message.time / 1000;
+            varlen(track, tick - last);
+            last = tick;
+            if (message.bytes[0] == 0xF0)
+            {
+                track.push_back(0xF0);
+                varlen(track, message.bytes.size() - 1);
+                track.insert(track.end(), message.bytes.begin() + 1, message.bytes.end());
+            }
+            else
+                track.insert(track.end(), message.bytes.begin(), message.bytes.end());
+        }
+        if (!track.empty())
+            tracks.push_back(track);
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+    const uint8_t header[] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, (uint8_t)tracks.size(), 0x01, 0xF4}; // 500 ticks per quarter
+    fwrite(header, 1, sizeof(header), file);
+    for (std::vector<uint8_t> &track : tracks)
+    {
+        track.insert(track.end(), {0x00, 0xFF, 0x2F, 0x00});
+        const uint8_t chunk[] = {'M', 'T', 'r', 'k', (uint8_t)(track.size() >> 24), (uint8_t)(track.size() >> 16),
+                                 (uint8_t)(track.size() >> 8), (uint8_t)track.size()};
+        fwrite(chunk, 1, sizeof(chunk), file);
+        fwrite(track.data(), 1, track.size(), file);
+    }
+    fclose(file);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Fresh filesystem for every run, with the calibration the traces are written for
+std::string MakeFilesystem(const char *configuration)
+{
+    char root[] = "/tmp/t16replay.XXXXXX";
+    if (!mkdtemp(root))
+        return "";
+    std::string path = root;
+    FILE *file = fopen((path + "/calibration_data.json").c_str(), "w");
+    if (!file)
+        return "";
+    fprintf(file, "{\"minVal\":[");
+    for (uint8_t i = 0; i < 16; i++)
+        fprintf(file, "%s%d", i ? "," : "", REPLAY_CAL_MIN);
+    fprintf(file, "],\"maxVal\":[");
+    for (uint8_t i = 0; i < 16; i++)
+        fprintf(file, "%s%d", i ? "," : "", REPLAY_CAL_MAX);
+    fprintf(file, "]}");
+    fclose(file);
+
+    if (configuration)
+    {
+        std::ifstream in(configuration, std::ios::binary);
+        std::ofstream out(path + "/configuration_data.json", std::ios::binary);
+        if (!in || !(out << in.rdbuf()))
+        {
+            fprintf(stderr, "can't copy configuration %s\n", configuration);
+            return "";
+        }
+    }
+    LittleFS.SetRoot(path.c_str());
+    return path;
+}
+
+void RemoveFilesystem(const std::string &path)
+{
+    unlink((path + "/calibration_data.json").c_str());
+    unlink((path + "/configuration_data.json").c_str());
+    rmdir(path.c_str());
+}
+
+// heap holds a sample after setup and one at the end of every repeat
+int Replay(Trace &trace, std::vector<MidiMessage> &messages, std::vector<HeapSample> &heap)
+{
+    // untouched pads while the slider calibrates
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+        HostTouch::Set(digitalPinToTouchChannel(slider_sensor[i]), REPLAY_PAD_BASE);
+
+    HostClock::Reset();
+    {
+        FirmwareHeap firmware;
+        setup();
+    }
+    // the stored calibration is the replay's, set it again in case setup changes it
+    uint16_t cal_min[16], cal_max[16];
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        cal_min[i] = REPLAY_CAL_MIN;
+        cal_max[i] = REPLAY_CAL_MAX;
+    }
+    adc.SetCalibration(cal_min, cal_max, 16);
+
+    // key of each mux channel
+    int8_t channel_key[16];
+    memset(channel_key, -1, sizeof(channel_key));
+    for (uint8_t i = 0; i < Matrix::SIZE; i++)
+        channel_key[keys[i].mux_idx] = keys[i].idx;
+
+    const uint64_t start = micros();
+    HostAnalog::Source() = [&](uint8_t pin) -> uint16_t
+    {
+        uint8_t channel = digitalRead(PIN_S0) | digitalRead(PIN_S1) << 1 | digitalRead(PIN_S2) << 2 | digitalRead(PIN_S3) << 3;
+        if (channel_key[channel] < 0)
+            return REPLAY_CAL_MAX;
+        float depth = constrain(trace.keys[channel_key[channel]].At(micros() - start), 0.0f, 1.0f);
+        return REPLAY_CAL_MAX - depth * (REPLAY_CAL_MAX - REPLAY_CAL_MIN);
+    };
+
+    MidiParser parsers[PORT_AMOUNT];
+    auto collect = [&]()
+    {
+        parsers[USB].Feed(HostUsb::Written(), USB, messages);
+        parsers[BLE].Feed(HostBle::Written(), BLE, messages);
+        parsers[UART].Feed(Serial2.Written(), UART, messages);
+    };
+    collect();
+    size_t setup_messages = messages.size();
+    heap.push_back({HostHeap::Used(), HostHeap::Allocations()});
+
+    uint64_t next_adc = start, next_loop = start, next_slider = start, next_scan = start;
+    uint64_t next_sample = trace.period;
+    size_t next_button = 0;
+    const uint64_t end = start + trace.duration;
+    while (micros() < end)
+    {
+        uint64_t now = min(min(next_adc, next_loop), min(next_slider, next_scan));
+        if (now > micros())
+            HostClock::Advance(now - micros());
+        uint64_t time = now - start;
+        if (time >= next_sample && next_sample < trace.duration)
+        {
+            heap.push_back({HostHeap::Used(), HostHeap::Allocations()});
+            next_sample += trace.period;
+        }
+
+        FirmwareHeap firmware;
+        while (next_button < trace.buttons.size() && trace.buttons[next_button].time <= time)
+        {
+            const ButtonEvent &event = trace.buttons[next_button++];
+            HostGpio::Set(event.pin, event.down ? LOW : HIGH);
+        }
+        HostTimers::Run();
+
+        if (now == next_scan)
+        {
+            float strength;
+            float position = trace.slider.At(time, strength);
+            for (uint8_t i = 0; i < NUM_SENSORS; i++)
+            {
+                float distance = fabsf(position * (NUM_SENSORS - 1) - i) / REPLAY_FINGER_WIDTH;
+                float finger = strength * REPLAY_FINGER * max(0.0f, 1.0f - distance);
+                HostTouch::Set(digitalPinToTouchChannel(slider_sensor[i]), REPLAY_PAD_BASE + finger + trace.pads[i].At(time));
+            }
+            HostTouch::Scan();
+            next_scan += REPLAY_SCAN_US;
+        }
+        if (now == next_adc)
+        {
+            adc.ReadValues();
+            next_adc += REPLAY_ADC_US;
+        }
+        if (now == next_slider)
+        {
+            slider.Update();
+            next_slider += SLIDER_TASK_PERIOD_MS * 1000;
+        }
+        if (now == next_loop)
+        {
+            loop();
+            Serial.Written().clear();
+            count_heap = false;
+            collect();
+            next_loop += REPLAY_LOOP_US;
+        }
+    }
+    heap.push_back({HostHeap::Used(), HostHeap::Allocations()});
+
+    // timed from the start of the trace, setup's messages at 0
+    for (size_t i = 0; i < messages.size(); i++)
+        messages[i].time = i < setup_messages ? 0 : messages[i].time - start;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = nullptr, *text = nullptr, *smf = nullptr, *golden = nullptr, *configuration = nullptr;
+    bool record = false, serial = false;
+    uint32_t repeat = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--text" && hasValue)
+            text = argv[++i];
+        else if (arg == "--smf" && hasValue)
+            smf = argv[++i];
+        else if (arg == "--golden" && hasValue)
+            golden = argv[++i];
+        else if (arg == "--config" && hasValue)
+            configuration = argv[++i];
+        else if (arg == "--repeat" && hasValue)
+            repeat = atoi(argv[++i]) > 0 ? atoi(argv[i]) : 1;
+        else if (arg == "--record")
+            record = true;
+        else if (arg == "--serial")
+            serial = true;
+        else if (arg == "--log")
+            HostLog::Enabled() = true;
+        else
+            path = argv[i];
+    }
+    if (!path)
+    {
+        fprintf(stderr, "usage: %s <trace> [--text out.txt] [--smf out.mid] [--golden file.txt [--record]] [--config file.json]\n"
+                        "       [--repeat n] [--serial] [--log]\n",
+                argv[0]);
+        return 2;
+    }
+
+    Trace trace;
+    if (!trace.Load(path, repeat))
+        return 2;
+    std::string root = MakeFilesystem(configuration);
+    if (root.empty())
+    {
+        fprintf(stderr, "can't set up the filesystem\n");
+        return 2;
+    }
+    Serial.SetEcho(serial ? stdout : nullptr);
+
+    std::vector<MidiMessage> messages;
+    std::vector<HeapSample> heap;
+    auto started = std::chrono::steady_clock::now();
+    Replay(trace, messages, heap);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    RemoveFilesystem(root);
+
+    std::string log;
+    uint32_t counts[PORT_AMOUNT] = {};
+    for (const MidiMessage &message : messages)
+    {
+        log += Describe(message) + "\n";
+        counts[message.port]++;
+    }
+    uint32_t hash = 2166136261u; // FNV-1a of the text log
+    for (char c : log)
+        hash = (hash ^ (uint8_t)c) * 16777619u;
+    printf("%s: %.1f s in %.2f s, %zu messages (usb %u, ble %u, uart %u), hash %08x\n", path, trace.duration / 1e6, elapsed,
+           messages.size(), counts[USB], counts[BLE], counts[UART], hash);
+
+    // the heap held at the end of every repeat must not grow past the first one
+    const HeapSample &first = heap[1], &last = heap.back();
+    size_t passes = heap.size() - 1;
+    size_t allocations = passes > 1 ? (last.allocations - first.allocations) / (passes - 1) : first.allocations - heap[0].allocations;
+    printf("heap: %zu bytes held after setup, %zu after the first pass, %zu at the end, %zu allocations per pass\n",
+           heap[0].used, first.used, last.used, allocations);
+    bool leaked = last.used > first.used;
+    if (leaked)
+        printf("FAIL: the heap held grew by %zu bytes over %zu passes\n", last.used - first.used, passes - 1);
+
+    if (text)
+    {
+        FILE *file = strcmp(text, "-") == 0 ? stdout : fopen(text, "w");
+        if (!file)
+            fprintf(stderr, "can't write %s\n", text);
+        else
+        {
+            fputs(log.c_str(), file);
+            if (file != stdout)
+                fclose(file);
+        }
+    }
+    if (smf && !WriteSmf(smf, messages))
+        fprintf(stderr, "can't write %s\n", smf);
+
+    if (golden && record)
+    {
+        std::ofstream out(golden);
+        if (!(out << log))
+        {
+            fprintf(stderr, "can't write %s\n", golden);
+            return 2;
+        }
+        printf("recorded %s\n", golden);
+    }
+    else if (golden)
+    {
+        std::ifstream in(golden);
+        if (!in)
+        {
+            fprintf(stderr, "can't read golden %s\n", golden);
+            return 2;
+        }
+        std::istringstream ours(log);
+        std::string expected, got;
+        for (int line = 1;; line++)
+        {
+            bool more_expected = (bool)std::getline(in, expected);
+            bool more_got = (bool)std::getline(ours, got);
+            if (!more_expected && !more_got)
+                break;
+            if (!more_expected || !more_got || expected != got)
+            {
+                printf("FAIL: line %d\n  golden: %s\n  replay: %s\n", line, more_expected ? expected.c_str() : "(end)",
+                       more_got ? got.c_str() : "(end)");
+                return 1;
+            }
+        }
+        printf("matches %s\n", golden);
+    }
+    return leaked ? 1 : 0;
+}
@@ -0,0 +1,271 @@
+// Checks the slider position estimator (src/Libs/SliderEstimator.hpp) against synthetic pad profiles.
+//
+//   slider_accuracy [--sigma pads] [--noise pct] [--verbose]
+//
+// A finger is a gaussian over the pads, of width sigma in pads, read through pads of uneven sensitivity
+// like a real slider. Single fingers are swept along the whole slider and pairs of fingers at growing
+// distances, with the per-pad gains set from the known sensitivities, learned from centered touches, and
+// left at unity for comparison. Reports the position error, the linearity and how often two fingers come
+// out as two touches, and exits 1 when the learned gains miss the limits below. Set gains are held to the
+// same limits for the default finger width only, they leave the estimator at its default width.
+
+#include "Libs/SliderEstimator.hpp"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#define PADS 7
+#define THRESHOLD 12000 // TouchSlider's touch threshold
+#define FINGER 40000    // filtered delta of a finger right over a pad, REPLAY_FINGER in the replay tool
+#define STEP 0.01       // pads between two single finger positions
+#define SIGMA 0.6       // pads, default finger width, the estimator's default too
+
+#define MAX_ERROR 0.05       // pads, worst single finger error with gains
+#define MAX_NONLINEARITY 0.05 // pads, worst distance from the best fit line with gains
+#define SEPARATE_FROM 3.0    // pads, two fingers at least this far apart must always be two touches
+#define MERGE_UNDER 1.5      // pads, two fingers closer than this must always be one touch
+
+typedef SliderEstimator<PADS> Estimator;
+
+// Sensitivity of each pad, the spread of a hand-built slider
+const double sensitivity[PADS] = {1.00, 0.85, 1.15, 0.95, 1.20, 0.80, 1.05};
+
+enum GainMode
+{
+    SET,
+    LEARNED,
+    UNITY,
+    GAIN_MODES
+};
+
+const char *gain_names[GAIN_MODES] = {"set", "learned", "unity"};
+
+class Profile
+{
+public:
+    Profile(double sigma, double noise) : sigma(sigma), noise(noise) {}
+
+    // Pad values for fingers at the given positions (pads) and strengths (1 is a full finger)
+    void Fill(int *values, const double *positions, const double *strengths, uint8_t fingers)
+    {
+        for (uint8_t i = 0; i < PADS; i++)
+        {
+            double value = 0.0;
+            for (uint8_t f = 0; f < fingers; f++)
+            {
+                double distance = (i - positions[f]) / sigma;
+                value += strengths[f] * FINGER * exp(-0.5 * distance * distance);
+            }
+            values[i] = (int)(value * sensitivity[i] + Noise());
+        }
+    }
+
+private:
+    double sigma, noise;
+    uint32_t seed = 12345;
+
+    // Same sequence on every run
+    double Noise()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return ((double)(seed >> 8) / (1 << 24) * 2.0 - 1.0) * noise / 100.0 * FINGER;
+    }
+};
+
+void SetUp(Estimator &estimator, GainMode mode, Profile &profile)
+{
+    estimator.SetGainLearning(false);
+    if (mode == SET)
+    {
+        for (uint8_t i = 0; i < PADS; i++)
+            estimator.SetGain(i, (uint16_t)lround(256.0 / sensitivity[i]));
+    }
+    else if (mode == LEARNED)
+    {
+        // centered touches on every pad, as the firmware learns them in use
+        estimator.SetGainLearning(true);
+        Estimator::Touch touches[Estimator::MAX_TOUCHES];
+        int values[PADS];
+        for (int round = 0; round < 64; round++)
+        {
+            for (uint8_t i = 0; i < PADS; i++)
+            {
+                double position = i, strength = 1.0;
+                profile.Fill(values, &position, &strength, 1);
+                estimator.Estimate(values, THRESHOLD, touches);
+            }
+        }
+        estimator.SetGainLearning(false);
+    }
+}
+
+double ToPads(uint16_t position)
+{
+    return position / 65535.0 * (PADS - 1);
+}
+
+struct Single
+{
+    double maxError = 0.0, rmsError = 0.0, nonlinearity = 0.0, slope = 0.0;
+    int missed = 0, split = 0, samples = 0;
+};
+
+Single SweepSingle(Estimator &estimator, Profile &profile, bool verbose)
+{
+    Single result;
+    Estimator::Touch touches[Estimator::MAX_TOUCHES];
+    int values[PADS];
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, sum = 0;
+    int n = 0;
+    static double truth[1024], estimate[1024];
+
+    for (int step = 0; step * STEP <= PADS - 1 + 1e-9; step++)
+    {
+        double position = step * STEP, strength = 1.0;
+        profile.Fill(values, &position, &strength, 1);
+        uint8_t count = estimator.Estimate(values, THRESHOLD, touches);
+        result.samples++;
+        if (count == 0)
+        {
+            result.missed++;
+            continue;
+        }
+        result.split += count > 1;
+        double found = ToPads(touches[0].position);
+        double error = fabs(found - position);
+        if (verbose)
+            printf("  %.2f -> %.3f (%+.3f)%s\n", position, found, found - position, count > 1 ? " split" : "");
+        result.maxError = fmax(result.maxError, error);
+        sum += error * error;
+        truth[n] = position;
+        estimate[n] = found;
+        sx += position;
+        sy += found;
+        sxx += position * position;
+        sxy += position * found;
+        n++;
+    }
+    if (n < 2)
+        return result;
+    result.rmsError = sqrt(sum / n);
+
+    // integral nonlinearity, worst distance from the least squares line
+    result.slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    double offset = (sy - result.slope * sx) / n;
+    for (int i = 0; i < n; i++)
+        result.nonlinearity = fmax(result.nonlinearity, fabs(estimate[i] - (result.slope * truth[i] + offset)));
+    return result;
+}
+
+struct Pair
+{
+    double distance;
+    int separated = 0, samples = 0;
+    double maxError = 0.0; // of both fingers, when separated
+};
+
+Pair SweepPair(Estimator &estimator, Profile &profile, double distance)
+{
+    Pair result;
+    result.distance = distance;
+    Estimator::Touch touches[Estimator::MAX_TOUCHES];
+    int values[PADS];
+    for (double first = 0.0; first + distance <= PADS - 1 + 1e-9; first += 0.05)
+    {
+        // the second finger pressing lighter, the touches are matched to the fingers by distance anyway
+        double positions[2] = {first, first + distance};
+        double strengths[2] = {1.0, 0.7};
+        profile.Fill(values, positions, strengths, 2);
+        uint8_t count = estimator.Estimate(values, THRESHOLD, touches);
+        result.samples++;
+        if (count < 2)
+            continue;
+        result.separated++;
+        double a = ToPads(touches[0].position), b = ToPads(touches[1].position);
+        double straight = fmax(fabs(a - positions[0]), fabs(b - positions[1]));
+        double crossed = fmax(fabs(a - positions[1]), fabs(b - positions[0]));
+        result.maxError = fmax(result.maxError, fmin(straight, crossed));
+    }
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    double sigma = SIGMA, noise = 0.0;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sigma" && hasValue)
+            sigma = atof(argv[++i]);
+        else if (arg == "--noise" && hasValue)
+            noise = atof(argv[++i]);
+        else if (arg == "--verbose")
+            verbose = true;
+        else
+        {
+            fprintf(stderr, "usage: %s [--sigma pads] [--noise pct] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const double distances[] = {1.0, 1.5, 2.0, 2.5, 3.0, 4.0, 5.0};
+    const int amount = sizeof(distances) / sizeof(distances[0]);
+    int failures = 0;
+
+    printf("sigma %.2f pads, noise %.1f%%, pad sensitivity", sigma, noise);
+    for (uint8_t i = 0; i < PADS; i++)
+        printf(" %.2f", sensitivity[i]);
+    printf("\n\n%-8s %9s %9s %9s %7s %7s %7s\n", "gains", "max err", "rms err", "nonlin", "slope", "missed", "split");
+    for (int mode = 0; mode < GAIN_MODES; mode++)
+    {
+        Profile profile(sigma, noise);
+        Estimator estimator;
+        SetUp(estimator, (GainMode)mode, profile);
+        if (verbose)
+            printf("%s:\n", gain_names[mode]);
+        Single single = SweepSingle(estimator, profile, verbose);
+        bool checked = mode == LEARNED || (mode == SET && sigma == SIGMA);
+        bool failed = checked && (single.maxError > MAX_ERROR || single.nonlinearity > MAX_NONLINEARITY ||
+                                        single.missed || single.split);
+        failures += failed;
+        printf("%-8s %9.4f %9.4f %9.4f %7.4f %7d %7d%s\n", gain_names[mode], single.maxError, single.rmsError,
+               single.nonlinearity, single.slope, single.missed, single.split, failed ? "  FAIL" : "");
+    }
+
+    printf("\ntwo fingers, %% of positions giving two touches, worst error of the two\n%-8s", "gains");
+    for (int d = 0; d < amount; d++)
+        printf(" %13.1f", distances[d]);
+    printf("\n");
+    for (int mode = 0; mode < GAIN_MODES; mode++)
+    {
+        Profile profile(sigma, noise);
+        Estimator estimator;
+        SetUp(estimator, (GainMode)mode, profile);
+        bool failed = false;
+        printf("%-8s", gain_names[mode]);
+        for (int d = 0; d < amount; d++)
+        {
+            Pair pair = SweepPair(estimator, profile, distances[d]);
+            float rate = 100.0f * pair.separated / pair.samples;
+            if (pair.separated)
+                printf(" %5.0f%% %6.3f", rate, pair.maxError);
+            else
+                printf(" %5.0f%% %6s", rate, "-");
+            if (distances[d] >= SEPARATE_FROM && pair.separated != pair.samples)
+                failed = true;
+            if (distances[d] < MERGE_UNDER && pair.separated)
+                failed = true;
+        }
+        failed = failed && (mode == LEARNED || (mode == SET && sigma == SIGMA));
+        failures += failed;
+        printf("%s\n", failed ? "  FAIL" : "");
+    }
+
+    printf("\n%s\n", failures ? "FAIL" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,243 @@
+#ifndef CHORDS_HPP
+#define CHORDS_HPP
+
+#include <stdint.h>
+#include "Scales.hpp"
+
+enum Chord
+{
+    MAJOR = 0,        // Major chord: root, major third, perfect fifth
+    MINOR,            // Minor chord: root, minor third, perfect fifth
+    SUSPENDED_FOURTH, // Suspended fourth chord: root, perfect fourth, perfect fifth
+    DIMINISH,         // Diminished chord: root, minor third, diminished fifth
+    AUGMENT,          // Augmented chord: root, major third, augmented fifth
+    SUSPENDED_SECOND, // Suspended second chord: root, major second, perfect fifth
+    QUARTAL,          // Quartal chord: root, perfect fourth, minor seventh
+    POWER,            // Power chord: root, perfect fifth
+    UNISON,           // Root only, used when the scale offers nothing else
+    CHORD_AMOUNT
+};
+
+// Chords that can be picked directly with the last row of keys in strum mode
+const uint8_t STRUM_CHORD_AMOUNT = 4;
+
+enum Voicing
+{
+    ROOT_POSITION = 0,
+    FIRST_INVERSION,
+    SECOND_INVERSION,
+    VOICING_AMOUNT
+};
+
+const uint8_t CHORD_SIZE = 4; // Notes in a pad voicing (triad + doubled root)
+const uint8_t STRUM_SIZE = 7; // One note per slider pad
+
+struct ChordShape
+{
+    uint8_t size;
+    int8_t intervals[3];
+};
+
+constexpr ChordShape chord_shapes[CHORD_AMOUNT] = {
+    {3, {0, 4, 7}},   // MAJOR
+    {3, {0, 3, 7}},   // MINOR
+    {3, {0, 5, 7}},   // SUSPENDED_FOURTH
+    {3, {0, 3, 6}},   // DIMINISH
+    {3, {0, 4, 8}},   // AUGMENT
+    {3, {0, 2, 7}},   // SUSPENDED_SECOND
+    {3, {0, 5, 10}},  // QUARTAL
+    {2, {0, 7, -1}},  // POWER
+    {1, {0, -1, -1}}, // UNISON
+};
+
+// Order in which the chords are tried when deriving the chord of a scale degree
+constexpr Chord chord_priority[CHORD_AMOUNT] = {MAJOR, MINOR, DIMINISH, AUGMENT, SUSPENDED_FOURTH, SUSPENDED_SECOND, QUARTAL, POWER, UNISON};
+
+// Chord tones stacked upwards over as many octaves as needed, index 0 being the root
+constexpr int8_t StackedTone(const ChordShape &shape, uint8_t index)
+{
+    return shape.intervals[index % shape.size] + 12 * (index / shape.size);
+}
+
+struct ChordVoicing
+{
+    uint8_t size;
+    int8_t notes[CHORD_SIZE];
+};
+
+struct VoicingTable
+{
+    ChordVoicing pads[CHORD_AMOUNT][VOICING_AMOUNT];
+    int8_t strum[CHORD_AMOUNT][STRUM_SIZE];
+};
+
+constexpr VoicingTable GenerateVoicings()
+{
+    VoicingTable table{};
+    for (uint8_t chord = 0; chord < CHORD_AMOUNT; chord++)
+    {
+        const ChordShape &shape = chord_shapes[chord];
+        // Every inversion moves the lowest tone of the previous one up an octave
+        for (uint8_t inversion = 0; inversion < VOICING_AMOUNT; inversion++)
+        {
+            ChordVoicing &voicing = table.pads[chord][inversion];
+            voicing.size = shape.size + 1;
+            for (uint8_t i = 0; i < CHORD_SIZE; i++)
+            {
+                voicing.notes[i] = i < voicing.size ? StackedTone(shape, inversion + i) : -1;
+            }
+        }
+        for (uint8_t i = 0; i < STRUM_SIZE; i++)
+        {
+            table.strum[chord][i] = StackedTone(shape, i);
+        }
+    }
+    return table;
+}
+
+constexpr VoicingTable voicing_table = GenerateVoicings();
+constexpr const int8_t (&strum_chords)[CHORD_AMOUNT][STRUM_SIZE] = voicing_table.strum;
+
+// Bitmask of the pitch classes of the scale, relative to the note of the given degree
+constexpr uint16_t DegreeIntervals(const int8_t *scale, uint8_t degree)
+{
+    uint8_t length = ScaleLength(scale);
+    if (length == 0)
+    {
+        return 1;
+    }
+    int8_t root = scale[degree % length];
+    uint16_t mask = 0;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        mask |= 1 << ((scale[i] - root + 144) % 12);
+    }
+    return mask;
+}
+
+constexpr bool ChordFits(const ChordShape &shape, uint16_t intervals)
+{
+    for (uint8_t i = 0; i < shape.size; i++)
+    {
+        if (!(intervals & (1 << (shape.intervals[i] % 12))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Picks the first chord (by priority) built only from notes of the scale
+constexpr Chord DegreeChord(const int8_t *scale, uint8_t degree)
+{
+    uint16_t intervals = DegreeIntervals(scale, degree);
+    for (uint8_t i = 0; i < CHORD_AMOUNT; i++)
+    {
+        if (ChordFits(chord_shapes[chord_priority[i]], intervals))
+        {
+            return chord_priority[i];
+        }
+    }
+    return UNISON;
+}
+
+struct DegreeChordTable
+{
+    uint8_t chords[SCALE_AMOUNT][12];
+};
+
+constexpr DegreeChordTable GenerateDegreeChords()
+{
+    DegreeChordTable table{};
+    for (uint8_t scale = 0; scale < SCALE_AMOUNT; scale++)
+    {
+        for (uint8_t degree = 0; degree < 12; degree++)
+        {
+            table.chords[scale][degree] = DegreeChord(scale_presets.steps[scale], degree);
+        }
+    }
+    return table;
+}
+
+constexpr DegreeChordTable degree_chords = GenerateDegreeChords();
+
+// Every voicing of every degree chord must only contain notes of its scale, in ascending order
+constexpr bool ValidateVoicings()
+{
+    for (uint8_t scale = 0; scale < SCALE_AMOUNT; scale++)
+    {
+        const int8_t *steps = scale_presets.steps[scale];
+        uint8_t length = ScaleLength(steps);
+        for (uint8_t degree = 0; degree < length; degree++)
+        {
+            uint8_t chord = degree_chords.chords[scale][degree];
+            uint16_t intervals = DegreeIntervals(steps, degree);
+            for (uint8_t inversion = 0; inversion < VOICING_AMOUNT; inversion++)
+            {
+                const ChordVoicing &voicing = voicing_table.pads[chord][inversion];
+                for (uint8_t i = 0; i < voicing.size; i++)
+                {
+                    if (!(intervals & (1 << (voicing.notes[i] % 12))))
+                        return false;
+                    if (i > 0 && voicing.notes[i] <= voicing.notes[i - 1])
+                        return false;
+                }
+            }
+            for (uint8_t i = 0; i < STRUM_SIZE; i++)
+            {
+                if (!(intervals & (1 << (strum_chords[chord][i] % 12))))
+                    return false;
+                if (i > 0 && strum_chords[chord][i] <= strum_chords[chord][i - 1])
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+constexpr bool DegreeChordsMatch(uint8_t scale, const Chord (&expected)[7])
+{
+    for (uint8_t degree = 0; degree < 7; degree++)
+    {
+        if (degree_chords.chords[scale][degree] != expected[degree])
+            return false;
+    }
+    return true;
+}
+
+static_assert(ValidateVoicings(), "chord voicing contains notes outside of its scale");
+static_assert(DegreeChordsMatch(IONIAN, {MAJOR, MINOR, MINOR, MAJOR, MAJOR, MINOR, DIMINISH}), "wrong IONIAN chords");
+static_assert(DegreeChordsMatch(DORIAN, {MINOR, MINOR, MAJOR, MAJOR, MINOR, DIMINISH, MAJOR}), "wrong DORIAN chords");
+static_assert(DegreeChordsMatch(PHRYGIAN, {MINOR, MAJOR, MAJOR, MINOR, DIMINISH, MAJOR, MINOR}), "wrong PHRYGIAN chords");
+static_assert(DegreeChordsMatch(LYDIAN, {MAJOR, MAJOR, MINOR, DIMINISH, MAJOR, MINOR, MINOR}), "wrong LYDIAN chords");
+static_assert(DegreeChordsMatch(MIXOLYDIAN, {MAJOR, MINOR, DIMINISH, MAJOR, MINOR, MINOR, MAJOR}), "wrong MIXOLYDIAN chords");
+static_assert(DegreeChordsMatch(AEOLIAN, {MINOR, DIMINISH, MAJOR, MINOR, MINOR, MAJOR, MAJOR}), "wrong AEOLIAN chords");
+static_assert(DegreeChordsMatch(LOCRIAN, {DIMINISH, MAJOR, MINOR, MINOR, MAJOR, MAJOR, MINOR}), "wrong LOCRIAN chords");
+static_assert(DegreeChordsMatch(HARMONIC_MINOR, {MINOR, DIMINISH, AUGMENT, MINOR, MAJOR, MAJOR, DIMINISH}), "wrong HARMONIC_MINOR chords");
+static_assert(DegreeChordsMatch(MELODIC_MINOR, {MINOR, MINOR, AUGMENT, MAJOR, MAJOR, DIMINISH, DIMINISH}), "wrong MELODIC_MINOR chords");
+
+uint8_t current_chord_mapping[16]; // Stores the current chord mapping for each key
+
+// Needs the degree map, so call it after SetNoteMap
+void SetChordMapping(uint8_t scale)
+{
+    for (int i = 0; i < 16; i++)
+    {
+        if (scale < CUSTOM1)
+        {
+            current_chord_mapping[i] = degree_chords.chords[scale][degree_map[i]];
+        }
+        else
+        {
+            // Custom scales can change at runtime, derive them on the fly
+            current_chord_mapping[i] = DegreeChord(scales[scale], degree_map[i]);
+        }
+    }
+}
+
+const ChordVoicing &GetChordVoicing(uint8_t chord, uint8_t inversion = ROOT_POSITION)
+{
+    return voicing_table.pads[chord % CHORD_AMOUNT][inversion % VOICING_AMOUNT];
+}
+
+#endif // CHORDS_HPP
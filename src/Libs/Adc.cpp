@@ -1,4 +1,5 @@
-#include "adc.hpp"
+#include "Adc.hpp"
+#include "CpuMonitor.hpp"
 
 #define ADC_BUFFER 512
 #define ADC_NUM_BYTES 64 // 256 samples of 16 bits
@@ -127,6 +128,7 @@ void Adc::Update(void *parameter)
 
     while (1)
     {
+        CpuSection section(CpuMonitor::ADC);
         adcInstance->ReadValues();
         // vTaskDelay(1);
     }
@@ -134,14 +136,29 @@ void Adc::Update(void *parameter)
 
 void Adc::ReadValues()
 {
-    uint8_t value_index = 0;
     SetMuxChannel(iterator);
     uint16_t i_v = analogRead(_config._pin);
+#ifdef LATENCY_TRACE
+    _channels[iterator].sampleTime = micros();
+#endif
+    Process(i_v);
+}
+
+void Adc::Process(uint16_t i_v)
+{
+    uint8_t value_index = 0;
     i_v = constrain(map(i_v, _channels[iterator].minVal, _channels[iterator].maxVal, 4095, 0), 0, 4095);
 
     _channels[iterator].buffer[avg_iterator] = i_v;
     i_v = AverageValue(iterator);
-    _channels[iterator].value = (float)i_v / 4095.0f;
+    float value = (float)i_v / 4095.0f;
+#ifdef LATENCY_TRACE
+    // the key task polls later, by then newer conversions may have come in
+    AdcChannel &channel = _channels[iterator];
+    if (value > channel.traceThreshold && channel.value <= channel.traceThreshold)
+        channel.crossingTime = channel.sampleTime;
+#endif
+    _channels[iterator].value = value;
 
     // fonepole(_channels[value_index].value, v, 0.5f);
     iterator++;
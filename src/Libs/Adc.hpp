@@ -33,6 +33,11 @@ public:
         uint16_t minVal = 2584;
         uint16_t maxVal = 3770;
         uint16_t buffer[16] = {0};
+#ifdef LATENCY_TRACE
+        ulong sampleTime = 0;        // us, last conversion
+        float traceThreshold = 1.0f; // value whose upward crossing is latched, above range until set
+        ulong crossingTime = 0;      // us, conversion that last took the value above traceThreshold
+#endif
     };
 
     Adc();  // constructor
@@ -51,9 +56,14 @@ public:
     static void Update(void *parameter);                                 // method to update
     void ReadValues();                                                   // method to read the values from the ADC
     void ReadValuesDMA();                                                // method to read the values from the ADC using DMA
+    void Process(uint16_t raw);                                          // method to filter a conversion of the current channel and move to the next
     float Get(uint8_t chn) const;                                        // method to get the value of a channel as a float
     float GetMux(uint8_t chn, uint8_t index) const;                      // method to get the value of a mux channel as a float
     uint16_t GetRaw() const;                                             // method to get the raw value of a channel
+#ifdef LATENCY_TRACE
+    void SetTraceThreshold(uint8_t index, float threshold) { _channels[index].traceThreshold = threshold; };
+    ulong GetCrossingTime(uint8_t index) const { return _channels[index].crossingTime; };
+#endif
     inline static void fonepole(float &out, float in, float coeff)
     {
         out = (in * coeff) + (out * (1.0f - coeff));
@@ -0,0 +1,271 @@
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+// Microbenchmarks of the hot paths, the same suite on the board and on the host (host/bench).
+// Only built with -DBENCHMARKS. Every run of a case is timed on its own, with the cycle counter on the
+// ESP32 and std::chrono on the host, and printed as one table in ns so the two can be put side by side.
+// The median is the number to track, interrupts and the host's scheduler end up in the average and max.
+// The "overhead" case times an empty run, the floor of every other number.
+//
+// Cases run on their own copies of the ADC, keys, slider, patterns and MIDI interface, fed with synthetic
+// input, and leave the live ones alone. Patterns draw into the shared pattern layer, on the board the
+// LEDs show garbage until the next frame. The DataManager cases write and remove /bench.json.
+
+#ifdef BENCHMARKS
+
+#include <Arduino.h>
+#include <vector>
+#include <algorithm>
+#ifndef ESP_PLATFORM
+#include <chrono>
+#endif
+#include "Adc.hpp"
+#include "Keyboard.hpp"
+#include "TouchSlider.hpp"
+#include "Signal.hpp"
+#include "MidiProvider.hpp"
+#include "DataManager.hpp"
+#include "Leds/LedManager.hpp"
+
+class Benchmark
+{
+public:
+    struct Result
+    {
+        const char *name;
+        uint32_t runs;
+        uint32_t median, avg, min, max; // ns
+    };
+
+    static const char *ClockName()
+    {
+#ifdef ESP_PLATFORM
+        static char name[32];
+        snprintf(name, sizeof(name), "cycle counter, %u MHz", (unsigned)ESP.getCpuFreqMHz());
+        return name;
+#else
+        return "std::chrono::steady_clock";
+#endif
+    }
+
+    template <typename Function>
+    static Result Measure(const char *name, uint32_t runs, Function function)
+    {
+        std::vector<uint32_t> times(runs);
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < runs; i++)
+        {
+            uint32_t start = Now();
+            function(i);
+            times[i] = Now() - start;
+            total += times[i];
+        }
+        std::sort(times.begin(), times.end());
+        return {name, runs, ToNs(times[runs / 2]), ToNs(total / runs), ToNs(times.front()), ToNs(times.back())};
+    }
+
+private:
+    // Ticks of the clock, cycles on the ESP32, ns on the host
+#ifdef ESP_PLATFORM
+    static uint32_t Now() { return ESP.getCycleCount(); }
+    static uint32_t ToNs(uint32_t cycles) { return (uint64_t)cycles * 1000 / ESP.getCpuFreqMHz(); }
+#else
+    static uint32_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    static uint32_t ToNs(uint32_t ns) { return ns; }
+#endif
+};
+
+// MIDI goes nowhere, only the encoding is timed
+class NullStream
+{
+public:
+    void begin(unsigned long baud) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t write(uint8_t value)
+    {
+        written++;
+        return 1;
+    }
+    uint32_t written = 0;
+};
+
+namespace Benchmarks
+{
+    static const uint32_t RUNS = 2000;
+    static const uint32_t PATTERN_RUNS = 500;
+    static const uint32_t FILE_RUNS = 20; // flash writes on the board
+
+    // Press depth of key k at run i, every key goes down and up out of step with the others
+    inline uint16_t KeyRaw(uint8_t key, uint32_t run)
+    {
+        uint32_t phase = (run + key * 37) % 200;
+        uint32_t depth = phase < 100 ? phase : 200 - phase; // 0 to 100
+        return 3770 - depth * (3770 - 2584) / 100;
+    }
+
+    // Raw touch value of pad p at run i, an untouched pad reads about 30000 and a finger right over it adds
+    // up to 40000. The finger sweeps the slider once every 256 runs.
+    inline uint32_t SliderRaw(uint8_t pad, uint32_t run, bool touched)
+    {
+        if (!touched)
+            return 30000;
+        uint32_t phase = run % 256;
+        int32_t position = (phase < 128 ? phase : 256 - phase) * (NUM_SENSORS - 1) * 2; // pads * 256
+        int32_t distance = abs(position - pad * 256);
+        return 30000 + (distance < 384 ? 40000 * (384 - distance) / 384 : 0);
+    }
+
+    template <typename Out>
+    std::vector<Benchmark::Result> Run(Out &out)
+    {
+        std::vector<Benchmark::Result> results;
+
+        results.push_back(Benchmark::Measure("overhead", RUNS, [](uint32_t i) {}));
+
+        // ADC filtering, a full pass over the 16 mux channels per run
+        AdcChannelConfig adc_config;
+        for (uint8_t i = 0; i < AdcChannelConfig::MUX_SEL_LAST; i++)
+            adc_config._mux_pin[i] = 1; // never driven, Process doesn't touch the pins
+        Adc adc;
+        adc.Init(&adc_config, 16);
+        results.push_back(Benchmark::Measure("adc_process", RUNS, [&](uint32_t i)
+                                             {
+                                                 for (uint8_t channel = 0; channel < 16; channel++)
+                                                     adc.Process(KeyRaw(channel, i));
+                                             }));
+
+        // Keyboard, keys moving through their states, in the modes that do extra work
+        static Key keys[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+        uint32_t emitted = 0;
+        for (uint8_t i = 0; i < 16; i++)
+        {
+            keys[i].idx = i;
+            keys[i].onStateChanged.DisconnectAll();
+        }
+        KeyboardConfig keyboard_config;
+        keyboard_config.Init(keys, 16);
+        Keyboard keyboard;
+        keyboard.Init(&keyboard_config, &adc);
+        keyboard.SetOnStateChanged([&](int idx, Key::State state)
+                                   { emitted++; });
+        const Mode modes[] = {Mode::KEYBOARD, Mode::XY_PAD, Mode::STRIPS};
+        const char *mode_names[] = {"keyboard_update", "keyboard_xy", "keyboard_strips"};
+        for (uint8_t m = 0; m < 3; m++)
+        {
+            keyboard.SetMode(modes[m]);
+            results.push_back(Benchmark::Measure(mode_names[m], RUNS, [&](uint32_t i)
+                                                 {
+                                                     for (uint8_t channel = 0; channel < 16; channel++)
+                                                         adc.Process(KeyRaw(channel, i));
+                                                     keyboard.Update();
+                                                 }));
+            // the ADC pass is in there too, take it out with adc_process
+        }
+        keyboard.RemoveOnStateChanged();
+
+        // Slider filtering and position, on pads that are never initialised: the live slider keeps the touch
+        // channels. Raw values come from a finger sweeping up and down. The estimator alone gets two fingers.
+        TouchSlider slider;
+        for (uint8_t pad = 0; pad < NUM_SENSORS; pad++)
+            slider.t[pad].Calibrate(SliderRaw(pad, 0, false));
+        results.push_back(Benchmark::Measure("slider_read", RUNS, [&](uint32_t i)
+                                             {
+                                                 uint32_t raw[NUM_SENSORS];
+                                                 for (uint8_t pad = 0; pad < NUM_SENSORS; pad++)
+                                                     raw[pad] = SliderRaw(pad, i, true);
+                                                 slider.ReadValues(raw);
+                                             }));
+        SliderEstimator<NUM_SENSORS> estimator;
+        SliderEstimator<NUM_SENSORS>::Touch found[SliderEstimator<NUM_SENSORS>::MAX_TOUCHES];
+        results.push_back(Benchmark::Measure("slider_estimate", RUNS, [&](uint32_t i)
+                                             {
+                                                 int values[NUM_SENSORS] = {0, 14000, 30000 + (int)(i % 64) * 100, 12000, 0, 26000, 9000};
+                                                 estimator.Estimate(values, 12000, found);
+                                             }));
+
+        // Signals, as the keys use them
+        Signal<int, Key::State> signal;
+        signal.Connect([&](int idx, Key::State state)
+                       { emitted++; });
+        results.push_back(Benchmark::Measure("signal_emit_1", RUNS, [&](uint32_t i)
+                                             { signal.Emit(i & 15, Key::PRESSED); }));
+        for (uint8_t i = 0; i < 3; i++)
+            signal.Connect([&](int idx, Key::State state)
+                           { emitted++; });
+        results.push_back(Benchmark::Measure("signal_emit_4", RUNS, [&](uint32_t i)
+                                             { signal.Emit(i & 15, Key::PRESSED); }));
+
+        // MIDI encoding with the firmware's settings
+        NullStream stream;
+        midi::SerialMIDI<NullStream, CustomSettings> serial_midi(stream);
+        midi::MidiInterface<midi::SerialMIDI<NullStream, CustomSettings>> midi(serial_midi);
+        midi.begin();
+        results.push_back(Benchmark::Measure("midi_note_on", RUNS, [&](uint32_t i)
+                                             { midi.sendNoteOn(36 + (i & 31), 100, 1); }));
+        results.push_back(Benchmark::Measure("midi_pitch_bend", RUNS, [&](uint32_t i)
+                                             { midi.sendPitchBend((int)(i & 8191) - 4096, 1); }));
+        uint8_t sysex[64] = {127, 7, 7};
+        results.push_back(Benchmark::Measure("midi_sysex_64", RUNS, [&](uint32_t i)
+                                             { midi.sendSysEx(sizeof(sysex), sysex); }));
+
+        // Patterns, fed a touch, a note and a strip every 32 frames
+        static Drops drops;
+        static Sea sea;
+        static Sea2 sea2;
+        static NoBlur no_blur;
+        static TouchBlur touch_blur;
+        static Strips strips;
+        static Strum strum;
+        static QuickSettings quick;
+        static Ripples ripples;
+        Pattern *patterns[] = {&drops, &sea, &sea2, &no_blur, &touch_blur, &strips, &strum, &quick, &ripples};
+        const char *pattern_names[] = {"pattern_drops", "pattern_sea", "pattern_sea2", "pattern_no_blur", "pattern_touch_blur",
+                                       "pattern_strips", "pattern_strum", "pattern_quick", "pattern_ripples"};
+        for (uint8_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++)
+        {
+            Pattern *pattern = patterns[p];
+            results.push_back(Benchmark::Measure(pattern_names[p], PATTERN_RUNS, [&](uint32_t i)
+                                                 {
+                                                     if (i % 32 == 0)
+                                                     {
+                                                         uint8_t key = (i / 32) % Matrix::SIZE;
+                                                         pattern->SetPosition((uint8_t)(key % Matrix::WIDTH), (uint8_t)(key / Matrix::WIDTH));
+                                                         pattern->SetPosition(1.5f, 1.5f);
+                                                         pattern->Trigger(key % Matrix::WIDTH, key / Matrix::WIDTH, 100);
+                                                         pattern->SetStrip(key % 4, 2.5f);
+                                                         pattern->SetAmount(0.5f);
+                                                     }
+                                                     pattern->RunPattern(1000 / LED_FRAME_RATE);
+                                                 }));
+        }
+
+        // Configuration storage, a bank sized array through JSON and the filesystem
+        DataManager data("/bench.json");
+        uint8_t values[16] = {};
+        results.push_back(Benchmark::Measure("data_save", FILE_RUNS, [&](uint32_t i)
+                                             {
+                                                 values[i & 15] = i;
+                                                 data.SaveArray(values, "values", 16);
+                                             }));
+        results.push_back(Benchmark::Measure("data_load", FILE_RUNS, [&](uint32_t i)
+                                             { data.LoadArray(values, "values", 16); }));
+        LittleFS.remove("/bench.json");
+
+        out.printf("# benchmarks, %s, %u emits, %u MIDI bytes\n", Benchmark::ClockName(), (unsigned)emitted, (unsigned)stream.written);
+        out.printf("%-20s %8s %10s %10s %10s %10s\n", "name", "runs", "median ns", "avg ns", "min ns", "max ns");
+        for (const Benchmark::Result &result : results)
+        {
+            out.printf("%-20s %8u %10u %10u %10u %10u\n", result.name, (unsigned)result.runs, (unsigned)result.median,
+                       (unsigned)result.avg, (unsigned)result.min, (unsigned)result.max);
+        }
+        return results;
+    }
+}
+
+#endif // BENCHMARKS
+
+#endif // BENCHMARKS_HPP
@@ -0,0 +1,96 @@
+#include "Button.hpp"
+
+void Button::Init()
+{
+    pinMode(pin, INPUT_PULLUP);
+    pressed = GetRaw();
+
+    debounceTimer = xTimerCreate("debounce", max(pdMS_TO_TICKS(debounceTime), (TickType_t)1), pdFALSE, this, DebounceCallback);
+    longPressTimer = xTimerCreate("longpress", max(pdMS_TO_TICKS(longPressTime), (TickType_t)1), pdFALSE, this, LongPressCallback);
+    attachInterruptArg(digitalPinToInterrupt(pin), OnEdge, this, CHANGE);
+}
+
+void IRAM_ATTR Button::OnEdge(void *arg)
+{
+    // Every bounce pushes the debounce timer further, it only fires once the contact settled
+    Button *button = static_cast<Button *>(arg);
+    BaseType_t woken = pdFALSE;
+    xTimerResetFromISR(button->debounceTimer, &woken);
+    if (woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void Button::DebounceCallback(TimerHandle_t timer)
+{
+    static_cast<Button *>(pvTimerGetTimerID(timer))->OnDebounced();
+}
+
+void Button::LongPressCallback(TimerHandle_t timer)
+{
+    static_cast<Button *>(pvTimerGetTimerID(timer))->OnLongPress();
+}
+
+void Button::OnDebounced()
+{
+    bool reading = GetRaw();
+    if (reading == pressed)
+    {
+        // Bounced back to where it was
+        return;
+    }
+    pressed = reading;
+    unsigned long now = millis();
+
+    if (pressed)
+    {
+        pressStartTime = now;
+        longPressFlag = false;
+        // Also (re)starts the timer, and picks up SetLongPressTime changes
+        xTimerChangePeriod(longPressTimer, max(pdMS_TO_TICKS(longPressTime), (TickType_t)1), 0);
+        Post(PRESSED);
+        return;
+    }
+
+    xTimerStop(longPressTimer, 0);
+    if (longPressFlag)
+    {
+        Post(LONG_RELEASED);
+    }
+    else if (now - pressStartTime < clickTime)
+    {
+        if (doubleClickTime > 0 && lastClickTime > 0 && pressStartTime - lastClickTime < doubleClickTime)
+        {
+            // A double click does not start another one
+            lastClickTime = 0;
+            Post(DOUBLE_CLICKED);
+        }
+        else
+        {
+            lastClickTime = now;
+            Post(CLICKED);
+        }
+    }
+    else
+    {
+        Post(RELEASED);
+    }
+}
+
+void Button::OnLongPress()
+{
+    if (pressed)
+    {
+        longPressFlag = true;
+        Post(LONG_PRESSED);
+    }
+}
+
+void Button::Post(State next)
+{
+    if (!events.Push(next))
+    {
+        log_d("Button %d event queue full", id);
+    }
+}
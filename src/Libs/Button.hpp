@@ -2,8 +2,15 @@
 #define BUTTON_HPP
 
 #include <Arduino.h>
+#include <freertos/timers.h>
 #include "Signal.hpp"
+#include "RingBuffer.hpp"
 
+#define BUTTON_EVENT_QUEUE 16
+
+// Button driven by GPIO edge interrupts. Every edge restarts a one-shot debounce timer,
+// the click/long press/double click state machine runs on the timer callbacks, and the
+// resulting state changes are queued for the main loop. An idle button costs nothing.
 class Button
 {
 public:
@@ -15,20 +22,20 @@ public:
         RELEASED,
         LONG_PRESSED,
         LONG_RELEASED,
-
+        DOUBLE_CLICKED,
     };
 
     Button(int pin = 0, int id = 0, int debounceTime = 10)
         : pin(pin),
           id(id),
           debounceTime(debounceTime),
-          lastDebounceTime(0),
-          state(IDLE), prevState(IDLE),
+          state(IDLE),
           pressStartTime(0),
-          elapsedTime(0),
+          lastClickTime(0),
           longPressTime(650),
           clickTime(260),
-          previousReading(false),
+          doubleClickTime(0),
+          pressed(false),
           longPressFlag(false) {}
 
     void SetLongPressTime(unsigned long time)
@@ -36,122 +43,37 @@ public:
         longPressTime = time;
     }
 
+    // Time between two clicks to report the second as DOUBLE_CLICKED, 0 disables it
+    void SetDoubleClickTime(unsigned long time)
+    {
+        doubleClickTime = time;
+    }
+
     void Init(int id)
     {
         log_d("Button %d initialized", id);
         this->id = id;
-        pinMode(pin, INPUT_PULLUP);
+        Init();
     }
 
-    void Init()
-    {
-        pinMode(pin, INPUT_PULLUP);
-    }
+    void Init();
 
-    void Start()
-    {
-        xTaskCreatePinnedToCore(Button::taskUpdate, "button", 1024 * 2, this, 3, &_task, 0);
-    }
-
-    static void taskUpdate(void *pvParameters)
-    {
-        Button *button = static_cast<Button *>(pvParameters);
-        while (1)
-        {
-            button->Update();
-            vTaskDelay(pdMS_TO_TICKS(4));
-        }
-    }
-
-    bool GetRaw() { return reading; }
+    // Level of the pin right now, regardless of debouncing
+    bool GetRaw() { return !digitalRead(pin); }
 
+    // Dispatches the state changes queued by the timers, call it from the main loop.
+    // Like a polled button, CLICKED and the released states last for one call before going back to IDLE.
     void Update()
     {
-        reading = (bool)(!digitalRead(pin));
-
-        if (reading != previousReading)
+        if (state == CLICKED || state == DOUBLE_CLICKED || state == RELEASED || state == LONG_RELEASED)
         {
-            lastDebounceTime = millis();
-            previousReading = reading;
-            return;
+            SetState(IDLE);
         }
 
-        if ((millis() - lastDebounceTime) > debounceTime)
+        State next;
+        if (events.Pop(next))
         {
-            switch (state)
-            {
-            case IDLE:
-                if (reading)
-                {
-                    state = PRESSED;
-                    pressStartTime = millis();
-                    elapsedTime = 0;
-                }
-                break;
-
-            case PRESSED:
-                if (reading)
-                {
-                    elapsedTime = millis() - pressStartTime;
-                    if (elapsedTime > longPressTime)
-                    {
-                        state = LONG_PRESSED;
-                    }
-                }
-                else if (!reading)
-                {
-                    if ((millis() - pressStartTime) < clickTime)
-                    {
-                        state = CLICKED;
-                    }
-                    else
-                    {
-                        state = RELEASED;
-                    }
-                }
-                break;
-
-            case RELEASED:
-                if (reading)
-                {
-                    state = PRESSED;
-                    pressStartTime = millis();
-                }
-                else
-                {
-                    state = IDLE;
-                }
-                break;
-
-            case LONG_PRESSED:
-                if (!reading)
-                {
-                    state = LONG_RELEASED;
-                }
-                break;
-
-            case LONG_RELEASED:
-                if (reading)
-                {
-                    state = PRESSED;
-                    pressStartTime = millis();
-                }
-                else
-                {
-                    state = IDLE;
-                }
-                break;
-
-            case CLICKED:
-                state = IDLE;
-                break;
-            }
-
-            if (prevState != state)
-            {
-                prevState = state;
-                onStateChanged.Emit(id, state);
-            }
+            SetState(next);
         }
     }
 
@@ -162,12 +84,15 @@ public:
 
     bool IsPressed()
     {
-        return reading;
+        return pressed;
     }
 
     float GetHoldTimeNormalized()
     {
-        return (float)elapsedTime / (float)longPressTime;
+        if (!pressed)
+            return 0.0f;
+        unsigned long elapsed = millis() - pressStartTime;
+        return elapsed > longPressTime ? 1.0f : (float)elapsed / (float)longPressTime;
     }
 
     Signal<int, Button::State> onStateChanged;
@@ -175,13 +100,33 @@ public:
 private:
     int pin, id;
     int debounceTime;
-    unsigned long lastDebounceTime;
-    State state, prevState;
-    bool previousReading, reading;
-    unsigned long pressStartTime, elapsedTime;
-    unsigned long longPressTime, clickTime;
+    State state;
+    volatile unsigned long pressStartTime;
+    unsigned long lastClickTime;
+    unsigned long longPressTime, clickTime, doubleClickTime;
+    volatile bool pressed;
     bool longPressFlag;
-    TaskHandle_t _task;
+    TimerHandle_t debounceTimer = nullptr;
+    TimerHandle_t longPressTimer = nullptr;
+    RingBuffer<State, BUTTON_EVENT_QUEUE> events;
+
+    void SetState(State next)
+    {
+        if (next != state)
+        {
+            state = next;
+            onStateChanged.Emit(id, state);
+        }
+    }
+
+    // Timer service task side
+    void OnDebounced();
+    void OnLongPress();
+    void Post(State next);
+
+    static void OnEdge(void *arg);
+    static void DebounceCallback(TimerHandle_t timer);
+    static void LongPressCallback(TimerHandle_t timer);
 };
 
-#endif // !BUTTON_HPP
\ No newline at end of file
+#endif // !BUTTON_HPP
@@ -0,0 +1,296 @@
+#ifndef CPUMONITOR_HPP
+#define CPUMONITOR_HPP
+
+#include <Arduino.h>
+#include <esp_freertos_hooks.h>
+#include "SysExPack.hpp"
+
+#define CPU_IDLE_GAP 20 // us, a longer gap between two idle hook calls means the idle task was preempted
+
+// Cycle counts of one core, only touched under its lock
+struct CpuCore
+{
+    uint32_t accounted = 0; // everything accounted on the core, wraps, only differences are used
+    uint64_t idle = 0;
+    uint32_t lastIdle = 0;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+// Where the CPU time goes, per task and per core, measured with the cycle counter of each core.
+// Instrumented code runs inside a CpuSection, the idle tasks are timed from the idle hooks.
+// Sections only count their own time: whatever was accounted on the same core while they were open,
+// a nested section or another task's section that preempted them, is taken out. What is left on a core
+// once the sections and idle are taken out is uninstrumented, the BLE and USB stacks, timers, ISRs.
+// While stopped a section costs a flag check and no idle hook is registered.
+class CpuMonitor
+{
+public:
+    enum Slot
+    {
+        ADC,    // adc task, core 1
+        LOOP,   // Arduino loop, core 1
+        USB,    // MIDI reads and writes on USB, from the loop
+        BLE,    // MIDI reads and writes on BLE, from the loop
+        SLIDER, // slider task, core 0
+        LEDS,   // LED output task, core 0
+        SLOT_AMOUNT
+    };
+
+    static const uint8_t CORE_AMOUNT = 2;
+    // Loop periods, power of two buckets from < 32 us up to >= 8 ms
+    static const uint8_t HISTOGRAM_SIZE = 10;
+
+    struct Report
+    {
+        ulong window;                     // us
+        uint16_t load[SLOT_AMOUNT];       // permille of a core
+        uint16_t idle[CORE_AMOUNT];       // permille
+        uint16_t other[CORE_AMOUNT];      // permille, uninstrumented
+        uint32_t loops;
+        uint32_t loopMin, loopAvg, loopMax; // us
+        uint32_t histogram[HISTOGRAM_SIZE];
+    };
+
+    static void Start()
+    {
+        if (running)
+            return;
+        Reset();
+        running = true;
+        esp_register_freertos_idle_hook_for_cpu(IdleHook<0>, 0);
+        esp_register_freertos_idle_hook_for_cpu(IdleHook<1>, 1);
+        log_d("CPU monitor started");
+    }
+
+    static void Stop()
+    {
+        if (!running)
+            return;
+        running = false;
+        esp_deregister_freertos_idle_hook_for_cpu(IdleHook<0>, 0);
+        esp_deregister_freertos_idle_hook_for_cpu(IdleHook<1>, 1);
+        log_d("CPU monitor stopped");
+    }
+
+    static bool IsRunning() { return running; };
+
+    // Once per loop iteration, for the period stats
+    static void OnLoop()
+    {
+        if (!running)
+            return;
+        ulong now = micros();
+        if (lastLoop != 0)
+        {
+            uint32_t period = now - lastLoop;
+            loopCount++;
+            loopSum += period;
+            loopMin = min(loopMin, period);
+            loopMax = max(loopMax, period);
+            histogram[Bucket(period)]++;
+        }
+        lastLoop = now;
+    }
+
+    // Everything since the previous report, or since Start, and starts a new window
+    static Report Collect()
+    {
+        Report report = {};
+        ulong now = micros();
+        report.window = now - windowStart;
+        uint64_t windowCycles = (uint64_t)report.window * ESP.getCpuFreqMHz();
+
+        uint64_t busy[SLOT_AMOUNT];
+        uint64_t idle[CORE_AMOUNT];
+        for (uint8_t core = 0; core < CORE_AMOUNT; core++)
+            portENTER_CRITICAL(&cores[core].lock);
+        memcpy(busy, cycles, sizeof(busy));
+        memset(cycles, 0, sizeof(cycles));
+        for (uint8_t core = 0; core < CORE_AMOUNT; core++)
+        {
+            idle[core] = cores[core].idle;
+            cores[core].idle = 0;
+        }
+        for (uint8_t core = CORE_AMOUNT; core > 0; core--)
+            portEXIT_CRITICAL(&cores[core - 1].lock);
+
+        uint64_t accounted[CORE_AMOUNT] = {idle[0], idle[1]};
+        for (uint8_t slot = 0; slot < SLOT_AMOUNT; slot++)
+        {
+            report.load[slot] = Permille(busy[slot], windowCycles);
+            accounted[SLOT_CORE[slot]] += busy[slot];
+        }
+        for (uint8_t core = 0; core < CORE_AMOUNT; core++)
+        {
+            report.idle[core] = Permille(idle[core], windowCycles);
+            report.other[core] = accounted[core] < windowCycles ? Permille(windowCycles - accounted[core], windowCycles) : 0;
+        }
+
+        report.loops = loopCount;
+        report.loopMin = loopCount > 0 ? loopMin : 0;
+        report.loopAvg = loopCount > 0 ? loopSum / loopCount : 0;
+        report.loopMax = loopMax;
+        memcpy(report.histogram, histogram, sizeof(histogram));
+
+        windowStart = now;
+        ResetLoopStats();
+        return report;
+    }
+
+    // Report as SysEx, 127 7 9 then every field 7 bits per byte, most significant first:
+    // window ms (3), load per slot (2 each), idle and other per core (2 each), loops (4),
+    // loop min, avg and max us (3 each), histogram counts (4 each)
+    static const uint16_t MAX_MESSAGE = 3 + 3 + SLOT_AMOUNT * 2 + CORE_AMOUNT * 4 + 4 + 9 + HISTOGRAM_SIZE * 4;
+
+    static uint16_t Pack(const Report &report, uint8_t *message)
+    {
+        message[0] = 127;
+        message[1] = 7;
+        message[2] = 9;
+        uint16_t size = 3;
+        size = PackSysEx7(message, size, report.window / 1000, 3);
+        for (uint8_t slot = 0; slot < SLOT_AMOUNT; slot++)
+            size = PackSysEx7(message, size, report.load[slot], 2);
+        for (uint8_t core = 0; core < CORE_AMOUNT; core++)
+        {
+            size = PackSysEx7(message, size, report.idle[core], 2);
+            size = PackSysEx7(message, size, report.other[core], 2);
+        }
+        size = PackSysEx7(message, size, report.loops, 4);
+        size = PackSysEx7(message, size, report.loopMin, 3);
+        size = PackSysEx7(message, size, report.loopAvg, 3);
+        size = PackSysEx7(message, size, report.loopMax, 3);
+        for (uint8_t i = 0; i < HISTOGRAM_SIZE; i++)
+            size = PackSysEx7(message, size, report.histogram[i], 4);
+        return size;
+    }
+
+    static const char *SlotName(uint8_t slot)
+    {
+        static const char *names[SLOT_AMOUNT] = {"adc", "loop", "usb", "ble", "slider", "leds"};
+        return slot < SLOT_AMOUNT ? names[slot] : "";
+    }
+
+    // Lower bound of a histogram bucket in us
+    static uint32_t BucketStart(uint8_t bucket) { return bucket == 0 ? 0 : 32UL << (bucket - 1); };
+
+    static constexpr uint8_t SLOT_CORE[SLOT_AMOUNT] = {1, 1, 1, 1, 0, 0};
+
+private:
+    friend class CpuSection;
+
+    static inline volatile bool running = false;
+    static inline CpuCore cores[CORE_AMOUNT];
+    static inline uint64_t cycles[SLOT_AMOUNT] = {};
+    static inline ulong windowStart = 0;
+
+    // Only touched from the loop
+    static inline ulong lastLoop = 0;
+    static inline uint32_t loopCount = 0;
+    static inline uint64_t loopSum = 0;
+    static inline uint32_t loopMin = UINT32_MAX;
+    static inline uint32_t loopMax = 0;
+    static inline uint32_t histogram[HISTOGRAM_SIZE] = {};
+
+    static void Reset()
+    {
+        for (uint8_t core = 0; core < CORE_AMOUNT; core++)
+        {
+            portENTER_CRITICAL(&cores[core].lock);
+            cores[core].idle = 0;
+            cores[core].lastIdle = 0;
+            portEXIT_CRITICAL(&cores[core].lock);
+        }
+        memset(cycles, 0, sizeof(cycles));
+        windowStart = micros();
+        lastLoop = 0;
+        ResetLoopStats();
+    }
+
+    static void ResetLoopStats()
+    {
+        loopCount = 0;
+        loopSum = 0;
+        loopMin = UINT32_MAX;
+        loopMax = 0;
+        memset(histogram, 0, sizeof(histogram));
+    }
+
+    static void Account(Slot slot, uint8_t core, uint32_t start, uint32_t accounted)
+    {
+        uint32_t now = ESP.getCycleCount();
+        CpuCore &state = cores[core];
+        portENTER_CRITICAL(&state.lock);
+        uint32_t elapsed = now - start;
+        uint32_t others = state.accounted - accounted;
+        uint32_t own = others < elapsed ? elapsed - others : 0;
+        state.accounted += own;
+        cycles[slot] += own;
+        portEXIT_CRITICAL(&state.lock);
+    }
+
+    // Called over and over by the idle task of the core while running, short gaps are idle time
+    template <uint8_t Index>
+    static bool IdleHook()
+    {
+        uint32_t now = ESP.getCycleCount();
+        CpuCore &state = cores[Index];
+        portENTER_CRITICAL(&state.lock);
+        uint32_t gap = now - state.lastIdle;
+        if (state.lastIdle != 0 && gap < CPU_IDLE_GAP * ESP.getCpuFreqMHz())
+        {
+            state.idle += gap;
+            state.accounted += gap;
+        }
+        state.lastIdle = now;
+        portEXIT_CRITICAL(&state.lock);
+        return false;
+    }
+
+    static uint8_t Bucket(uint32_t period)
+    {
+        uint32_t scaled = period >> 5;
+        if (scaled == 0)
+            return 0;
+        uint8_t bucket = 32 - __builtin_clz(scaled);
+        return bucket < HISTOGRAM_SIZE ? bucket : HISTOGRAM_SIZE - 1;
+    }
+
+    static uint16_t Permille(uint64_t part, uint64_t whole)
+    {
+        return whole > 0 ? (uint16_t)min<uint64_t>(part * 1000 / whole, 1000) : 0;
+    }
+};
+
+// Times the enclosing scope into a slot, the task must be pinned to a core
+class CpuSection
+{
+public:
+    CpuSection(CpuMonitor::Slot slot) : slot(slot)
+    {
+        active = CpuMonitor::running;
+        if (!active)
+            return;
+        core = xPortGetCoreID();
+        accounted = CpuMonitor::cores[core].accounted;
+        start = ESP.getCycleCount();
+    }
+
+    ~CpuSection()
+    {
+        if (active)
+            CpuMonitor::Account(slot, core, start, accounted);
+    }
+
+    CpuSection(const CpuSection &) = delete;
+    CpuSection &operator=(const CpuSection &) = delete;
+
+private:
+    CpuMonitor::Slot slot;
+    bool active;
+    uint8_t core = 0;
+    uint32_t start = 0;
+    uint32_t accounted = 0;
+};
+
+#endif // CPUMONITOR_HPP
@@ -3,7 +3,6 @@
 
 #include <ArduinoJson.h>
 #include <LittleFS.h>
-#include <StreamUtils.h>
 
 class DataManager
 {
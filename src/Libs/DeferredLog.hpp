@@ -0,0 +1,167 @@
+#ifndef DEFERREDLOG_HPP
+#define DEFERREDLOG_HPP
+
+#include <Arduino.h>
+#include <type_traits>
+#include "RingBuffer.hpp"
+
+// Debug logging for hot paths. LOG_DEFERRED stores the format string's address, a timestamp and the raw
+// arguments into a ring and returns, a low priority task formats and prints them later through log_d.
+// The control loop never waits on printf or the serial port, and a full ring drops records instead of
+// blocking. Arguments are integers or floats, at most DEFERRED_LOG_ARGS of them, no strings. The format
+// must be a literal, it is read when the record is printed.
+// Only the loop task may log this way, the ring has a single producer.
+// Like log_d it compiles to nothing below CORE_DEBUG_LEVEL 4.
+
+#define DEFERRED_LOG_ARGS 4
+#define DEFERRED_LOG_SIZE 64 // records, power of two
+#define DEFERRED_LOG_PERIOD 20 // ms between two runs of the printing task
+
+#if defined(CORE_DEBUG_LEVEL) && CORE_DEBUG_LEVEL >= 4
+
+class DeferredLog
+{
+public:
+    struct Record
+    {
+        const char *format;
+        ulong time; // ms
+        uint8_t count;
+        uint32_t args[DEFERRED_LOG_ARGS];
+    };
+
+    static void Start()
+    {
+        xTaskCreatePinnedToCore(DeferredLog::taskUpdate, "DeferredLog", 1024 * 3, nullptr, tskIDLE_PRIORITY, nullptr, 0);
+    }
+
+    template <typename... Args>
+    static void Log(const char *format, Args... args)
+    {
+        static_assert(sizeof...(Args) <= DEFERRED_LOG_ARGS, "too many arguments for a deferred log");
+        Record record;
+        record.format = format;
+        record.time = millis();
+        record.count = sizeof...(Args);
+        uint8_t i = 0;
+        ((record.args[i++] = Word(args)), ...);
+        if (!ring.Push(record))
+        {
+            dropped++;
+        }
+    }
+
+    // Formats one record, one conversion at a time since the arguments are only known as words
+    static void Format(const Record &record, char *out, size_t size)
+    {
+        size_t length = 0;
+        uint8_t arg = 0;
+        const char *c = record.format;
+        while (*c && length + 1 < size)
+        {
+            if (*c != '%')
+            {
+                out[length++] = *c++;
+                continue;
+            }
+            if (c[1] == '%')
+            {
+                out[length++] = '%';
+                c += 2;
+                continue;
+            }
+
+            // copy the conversion without its length modifiers, every argument is a 32 bit word
+            char spec[16];
+            uint8_t s = 0;
+            spec[s++] = *c++;
+            while (*c && strchr("-+ #0123456789.hlzjtL", *c))
+            {
+                if (!strchr("hlzjtL", *c) && s < sizeof(spec) - 2)
+                    spec[s++] = *c;
+                c++;
+            }
+            if (!*c)
+                break;
+            char conversion = *c++;
+            spec[s++] = conversion;
+            spec[s] = '\0';
+
+            uint32_t word = arg < record.count ? record.args[arg] : 0;
+            arg++;
+            int written;
+            if (strchr("spn", conversion))
+                written = snprintf(out + length, size - length, "?"); // no pointers in a record
+            else if (strchr("fFeEgGaA", conversion))
+            {
+                float value;
+                memcpy(&value, &word, sizeof(value));
+                written = snprintf(out + length, size - length, spec, (double)value);
+            }
+            else if (strchr("dic", conversion))
+                written = snprintf(out + length, size - length, spec, (int)word);
+            else
+                written = snprintf(out + length, size - length, spec, (unsigned)word);
+            if (written > 0)
+                length = min(length + written, size - 1);
+        }
+        out[length] = '\0';
+    }
+
+    static void taskUpdate(void *pvParameters)
+    {
+        char text[128];
+        Record record;
+        while (1)
+        {
+            while (ring.Pop(record))
+            {
+                Format(record, text, sizeof(text));
+                log_d("@%lu %s", record.time, text);
+            }
+            uint32_t lost = dropped.exchange(0);
+            if (lost > 0)
+            {
+                log_d("%u deferred log records dropped", lost);
+            }
+            vTaskDelay(pdMS_TO_TICKS(DEFERRED_LOG_PERIOD));
+        }
+    }
+
+private:
+    static inline RingBuffer<Record, DEFERRED_LOG_SIZE> ring;
+    static inline std::atomic<uint32_t> dropped{0};
+
+    template <typename T>
+    static uint32_t Word(T value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "deferred logs only take numbers");
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            float f = value;
+            uint32_t word;
+            memcpy(&word, &f, sizeof(word));
+            return word;
+        }
+        else
+        {
+            return static_cast<uint32_t>(value);
+        }
+    }
+};
+
+#define LOG_DEFERRED(format, ...) DeferredLog::Log(format, ##__VA_ARGS__)
+
+#else
+
+class DeferredLog
+{
+public:
+    static void Start() {}
+};
+
+#define LOG_DEFERRED(format, ...) ((void)0)
+
+#endif // CORE_DEBUG_LEVEL
+
+#endif // DEFERREDLOG_HPP
@@ -2,8 +2,9 @@
 #define KEYBOARD_HPP
 
 #include <stdint.h>
-#include "adc.hpp"
+#include "Adc.hpp"
 #include "Signal.hpp"
+#include "LatencyTrace.hpp"
 
 enum Mode
 {
@@ -11,6 +12,7 @@ enum Mode
     STRUM,
     XY_PAD,
     STRIPS,
+    CHORD,
     QUICK_SETTINGS,
     MODE_AMOUNT
 };
@@ -52,7 +54,9 @@ public:
             ulong pressTime = millis() - pressStartTime;
             velocity = fmap((float)pressTime, 55.0f, 4.0f, 0.18f, 1.0f);
 
+            TRACE_BEGIN(adc->GetCrossingTime(mux_idx));
             onStateChanged.Emit(idx, state);
+            TRACE_END();
         }
         else if (value < 0.14f && (state == PRESSED || state == AFTERTOUCH))
         {
@@ -101,6 +105,14 @@ public:
 
     Signal<int, Key::State> onStateChanged;
 
+#ifdef LATENCY_TRACE
+    // Has the ADC latch the time of the conversion that crosses the press threshold
+    void ArmTrace(Adc *adc) const
+    {
+        adc->SetTraceThreshold(mux_idx, press_threshold);
+    }
+#endif
+
     void SetATThreshold(float threshold)
     {
         at_threshold = threshold;
@@ -163,6 +175,10 @@ public:
     {
         _config = *cfg;
         _adc = adc;
+#ifdef LATENCY_TRACE
+        for (uint8_t i = 0; i < _config._key_amount; i++)
+            _config._keys[i].ArmTrace(adc);
+#endif
         GenerateLUTs();
         log_d("Keyboard initialized");
     };
@@ -0,0 +1,149 @@
+#ifndef LATENCYTRACE_HPP
+#define LATENCYTRACE_HPP
+
+// Press to wire latency, stamped at every stage a key press goes through on its way to the transports.
+// Only built with -DLATENCY_TRACE, without it the probes expand to nothing.
+//
+// A trace opens when a key crosses the press threshold and closes once the key's handlers returned.
+// Everything in between runs on the loop task, so stamps go to the one open trace and stamps without
+// an open trace (notes from the slider or the strummer) are ignored.
+
+#ifdef LATENCY_TRACE
+
+#include <Arduino.h>
+#include "SysExPack.hpp"
+
+class LatencyTrace
+{
+public:
+    enum Stage
+    {
+        SAMPLE,       // ADC conversion that crossed the threshold
+        THRESHOLD,    // key state machine saw the crossing
+        DISPATCH,     // key handler called
+        SEND,         // MidiProvider asked to send the note
+        ENQUEUE,      // transport send called
+        USB_HANDOFF,  // message written to the TinyUSB FIFO
+        BLE_HANDOFF,  // message handed to the BLE MIDI transport
+        UART_HANDOFF, // message written to the UART FIFO
+        TOTAL,        // sample to last handoff
+        STAGE_AMOUNT
+    };
+
+    // Power of two buckets from < 1 us up to >= 4 ms
+    static const uint8_t HISTOGRAM_SIZE = 14;
+
+    struct StageStats
+    {
+        uint32_t count;
+        uint32_t min, max; // us
+        uint64_t sum;
+        uint32_t histogram[HISTOGRAM_SIZE];
+    };
+
+    static void Begin(ulong sampleTime)
+    {
+        memset(stamps, 0, sizeof(stamps));
+        open = true;
+        stamps[SAMPLE] = sampleTime;
+        Stamp(THRESHOLD);
+    }
+
+    static void Stamp(Stage stage)
+    {
+        if (open && stamps[stage] == 0)
+            stamps[stage] = micros();
+    }
+
+    // Every stage is measured from the closest stage stamped before it, the total from the sample
+    static void End()
+    {
+        if (!open)
+            return;
+        open = false;
+        if (stamps[SEND] == 0)
+            return; // the press did not make a note
+
+        ulong previous = stamps[SAMPLE];
+        ulong last = previous;
+        for (uint8_t stage = THRESHOLD; stage < TOTAL; stage++)
+        {
+            if (stamps[stage] == 0)
+                continue;
+            Add(stats[stage], stamps[stage] - previous);
+            // the handoffs are all measured from the enqueue, not from each other
+            if (stage <= ENQUEUE)
+                previous = stamps[stage];
+            last = max(last, stamps[stage]);
+        }
+        Add(stats[TOTAL], last - stamps[SAMPLE]);
+    }
+
+    static const StageStats &Get(uint8_t stage) { return stats[stage]; };
+
+    static void Reset()
+    {
+        memset(stats, 0, sizeof(stats));
+    }
+
+    static const char *StageName(uint8_t stage)
+    {
+        static const char *names[STAGE_AMOUNT] = {"sample", "threshold", "dispatch", "send", "enqueue", "usb", "ble", "uart", "total"};
+        return stage < STAGE_AMOUNT ? names[stage] : "";
+    }
+
+    // Lower bound of a histogram bucket in us
+    static uint32_t BucketStart(uint8_t bucket) { return bucket == 0 ? 0 : 1UL << (bucket - 1); };
+
+    // Stats as SysEx, 127 7 11 then per stage count, min, avg and max us and the histogram counts,
+    // 3 bytes each, 7 bits per byte, most significant first
+    static const uint16_t MAX_MESSAGE = 3 + STAGE_AMOUNT * (4 + HISTOGRAM_SIZE) * 3;
+
+    static uint16_t Pack(uint8_t *message)
+    {
+        message[0] = 127;
+        message[1] = 7;
+        message[2] = 11;
+        uint16_t size = 3;
+        for (uint8_t stage = 0; stage < STAGE_AMOUNT; stage++)
+        {
+            const StageStats &stage_stats = stats[stage];
+            size = PackSysEx7(message, size, stage_stats.count, 3);
+            size = PackSysEx7(message, size, stage_stats.min, 3);
+            size = PackSysEx7(message, size, stage_stats.count > 0 ? stage_stats.sum / stage_stats.count : 0, 3);
+            size = PackSysEx7(message, size, stage_stats.max, 3);
+            for (uint8_t i = 0; i < HISTOGRAM_SIZE; i++)
+                size = PackSysEx7(message, size, stage_stats.histogram[i], 3);
+        }
+        return size;
+    }
+
+private:
+    static inline bool open = false;
+    static inline ulong stamps[TOTAL] = {};
+    static inline StageStats stats[STAGE_AMOUNT] = {};
+
+    static void Add(StageStats &stage_stats, uint32_t latency)
+    {
+        stage_stats.min = stage_stats.count == 0 ? latency : min(stage_stats.min, latency);
+        stage_stats.max = max(stage_stats.max, latency);
+        stage_stats.sum += latency;
+        stage_stats.count++;
+        uint8_t bucket = latency == 0 ? 0 : 32 - __builtin_clz(latency);
+        stage_stats.histogram[bucket < HISTOGRAM_SIZE ? bucket : HISTOGRAM_SIZE - 1]++;
+    }
+};
+
+#define TRACE_BEGIN(sample_time) LatencyTrace::Begin(sample_time)
+#define TRACE_STAMP(stage) LatencyTrace::Stamp(LatencyTrace::stage)
+#define TRACE_END() LatencyTrace::End()
+
+#else
+
+#define TRACE_BEGIN(sample_time) ((void)0)
+#define TRACE_STAMP(stage) ((void)0)
+#define TRACE_END() ((void)0)
+
+#endif // LATENCY_TRACE
+
+#endif // LATENCYTRACE_HPP
@@ -0,0 +1,94 @@
+#ifndef COMPOSITOR_HPP
+#define COMPOSITOR_HPP
+
+#include <FastLED.h>
+
+enum class BlendMode : uint8_t
+{
+    NORMAL,   // layer replaces what is below
+    ADD,      // saturating sum, black is transparent
+    SCREEN,   // 1 - (1 - a)(1 - b), brightens without clipping as hard as ADD
+    LIGHTEN,  // per channel maximum
+    MULTIPLY, // darkens, white is transparent
+};
+
+// Stacks same sized pixel layers bottom to top into an output buffer, in 8 bit fixed point
+template <uint8_t Layers>
+class Compositor
+{
+public:
+    void SetLayer(uint8_t idx, const CRGB *pixels, BlendMode mode, uint8_t opacity = 255)
+    {
+        layers[idx] = {pixels, mode, opacity, true};
+    }
+
+    void SetBlendMode(uint8_t idx, BlendMode mode) { layers[idx].mode = mode; };
+    void SetOpacity(uint8_t idx, uint8_t opacity) { layers[idx].opacity = opacity; };
+    void SetVisible(uint8_t idx, bool visible) { layers[idx].visible = visible; };
+
+    // Composes size pixels of every visible layer into out, starting from black
+    void Compose(CRGB *out, uint8_t size) const
+    {
+        for (uint8_t i = 0; i < size; i++)
+        {
+            CRGB pixel = CRGB::Black;
+            for (uint8_t l = 0; l < Layers; l++)
+            {
+                const Layer &layer = layers[l];
+                if (!layer.visible || layer.pixels == nullptr || layer.opacity == 0)
+                    continue;
+                CRGB blended = Blend(pixel, layer.pixels[i], layer.mode);
+                pixel = layer.opacity == 255 ? blended : blend(pixel, blended, layer.opacity);
+            }
+            out[i] = pixel;
+        }
+    }
+
+    static CRGB Blend(const CRGB &below, const CRGB &above, BlendMode mode)
+    {
+        switch (mode)
+        {
+        case BlendMode::ADD:
+            return CRGB(qadd8(below.r, above.r), qadd8(below.g, above.g), qadd8(below.b, above.b));
+        case BlendMode::SCREEN:
+            return CRGB(Screen(below.r, above.r), Screen(below.g, above.g), Screen(below.b, above.b));
+        case BlendMode::LIGHTEN:
+            return CRGB(max(below.r, above.r), max(below.g, above.g), max(below.b, above.b));
+        case BlendMode::MULTIPLY:
+            return CRGB(scale8(below.r, above.r), scale8(below.g, above.g), scale8(below.b, above.b));
+        case BlendMode::NORMAL:
+        default:
+            return above;
+        }
+    }
+
+    // FNV-1a over the final frame, extra lets global state like the brightness take part
+    static uint32_t Hash(const CRGB *pixels, uint16_t size, uint8_t extra = 0)
+    {
+        uint32_t hash = 2166136261UL ^ extra;
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(pixels);
+        for (uint16_t i = 0; i < size * sizeof(CRGB); i++)
+        {
+            hash = (hash ^ bytes[i]) * 16777619UL;
+        }
+        return hash;
+    }
+
+private:
+    struct Layer
+    {
+        const CRGB *pixels;
+        BlendMode mode;
+        uint8_t opacity;
+        bool visible;
+    };
+
+    Layer layers[Layers] = {};
+
+    static uint8_t Screen(uint8_t a, uint8_t b)
+    {
+        return 255 - scale8(255 - a, 255 - b);
+    }
+};
+
+#endif // COMPOSITOR_HPP
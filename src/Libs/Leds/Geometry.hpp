@@ -0,0 +1,96 @@
+#ifndef GEOMETRY_HPP
+#define GEOMETRY_HPP
+
+#include <stdint.h>
+
+// Maps matrix coordinates to LED indices, resolved at compile time.
+// Rows start at the top left, Serpentine reverses every odd row, FlipX/FlipY mirror the whole matrix.
+template <uint8_t Width, uint8_t Height, bool Serpentine = false, bool FlipX = false, bool FlipY = false>
+struct MatrixGeometry
+{
+    static constexpr uint8_t WIDTH = Width;
+    static constexpr uint8_t HEIGHT = Height;
+    static constexpr uint16_t SIZE = Width * Height;
+
+    static constexpr uint16_t Compute(uint8_t x, uint8_t y)
+    {
+        uint8_t column = FlipX ? Width - 1 - x : x;
+        uint8_t row = FlipY ? Height - 1 - y : y;
+        if (Serpentine && (row & 1))
+        {
+            column = Width - 1 - column;
+        }
+        return row * Width + column;
+    }
+
+    struct Table
+    {
+        uint16_t index[Height][Width];
+    };
+
+    static constexpr Table Generate()
+    {
+        Table table{};
+        for (uint8_t y = 0; y < Height; y++)
+        {
+            for (uint8_t x = 0; x < Width; x++)
+            {
+                table.index[y][x] = Compute(x, y);
+            }
+        }
+        return table;
+    }
+
+    static constexpr Table map = Generate();
+
+    // Unchecked, for loops that stay on the matrix
+    static constexpr uint16_t Index(uint8_t x, uint8_t y) { return map.index[y][x]; }
+
+    static constexpr bool Contains(int16_t x, int16_t y) { return x >= 0 && y >= 0 && x < Width && y < Height; }
+};
+
+// A strip of LEDs, optionally wired from its far end
+template <uint8_t Length, bool Reversed = false>
+struct StripGeometry
+{
+    static constexpr uint8_t LENGTH = Length;
+
+    static constexpr uint8_t Index(uint8_t i) { return Reversed ? Length - 1 - i : i; }
+};
+
+// Where every part of the board sits on the single WS2812B chain
+template <typename Matrix, typename Slider, uint8_t StatusOffset, uint8_t MatrixOffset, uint8_t SliderOffset>
+struct BoardGeometry
+{
+    using MatrixMap = Matrix;
+    using SliderMap = Slider;
+    static constexpr uint8_t STATUS_OFFSET = StatusOffset;
+    static constexpr uint8_t MATRIX_OFFSET = MatrixOffset;
+    static constexpr uint8_t SLIDER_OFFSET = SliderOffset;
+    static constexpr uint16_t LED_AMOUNT = Matrix::SIZE + Slider::LENGTH + 1;
+
+    static_assert(MatrixOffset + Matrix::SIZE <= LED_AMOUNT, "matrix runs past the end of the chain");
+    static_assert(SliderOffset + Slider::LENGTH <= LED_AMOUNT, "slider runs past the end of the chain");
+    static_assert(StatusOffset < LED_AMOUNT, "status led past the end of the chain");
+    static_assert(MatrixOffset + Matrix::SIZE <= SliderOffset || SliderOffset + Slider::LENGTH <= MatrixOffset, "matrix and slider overlap");
+};
+
+// status, matrix, slider
+using RevAGeometry = BoardGeometry<MatrixGeometry<4, 4>, StripGeometry<7, true>, 0, 1, 17>;
+// status, slider, matrix
+using RevBGeometry = BoardGeometry<MatrixGeometry<4, 4>, StripGeometry<7, true>, 0, 8, 1>;
+
+#ifdef REV_B
+using Board = RevBGeometry;
+#else
+using Board = RevAGeometry;
+#endif
+
+using Matrix = Board::MatrixMap;
+using Slider = Board::SliderMap;
+
+static_assert(Matrix::Index(0, 0) == 0 && Matrix::Index(3, 3) == 15, "unexpected matrix layout");
+static_assert(MatrixGeometry<4, 4, true>::Index(0, 1) == 7, "serpentine rows must be reversed");
+static_assert(Slider::Index(0) == 6, "slider is wired from its top end");
+
+#endif // GEOMETRY_HPP
@@ -0,0 +1,18 @@
+#include "LedBuffers.hpp"
+
+uint16_t XY(uint8_t x, uint8_t y)
+{
+    return Matrix::Contains(x, y) ? Matrix::Index(x, y) : Matrix::SIZE;
+}
+
+CRGB leds_plus_safety_pixel[Board::LED_AMOUNT + 1];
+CRGB *const leds(leds_plus_safety_pixel + 1);
+CRGBSet leds_set(leds, Board::LED_AMOUNT);
+CRGBSet stateled(leds_set(Board::STATUS_OFFSET, Board::STATUS_OFFSET));
+CRGBSet matrixleds(leds_set(Board::MATRIX_OFFSET, Board::MATRIX_OFFSET + Matrix::SIZE - 1));
+CRGBSet sliderleds(leds_set(Board::SLIDER_OFFSET, Board::SLIDER_OFFSET + Slider::LENGTH - 1));
+
+CRGB markerleds[Matrix::SIZE + 1];
+CRGB patternleds[Matrix::SIZE + 1];
+CRGB feedbackleds[Matrix::SIZE + 1];
+CRGB sliderlayer[Slider::LENGTH];
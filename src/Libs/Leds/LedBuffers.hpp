@@ -0,0 +1,25 @@
+#ifndef LEDBUFFERS_HPP
+#define LEDBUFFERS_HPP
+
+#include <FastLED.h>
+#include "Geometry.hpp"
+
+// Checked mapping, off the matrix it returns Matrix::SIZE, the safety pixel of the layers.
+// Loops that stay on the matrix use Matrix::Index directly. Defined out of line, FastLED's blur2d links against it.
+uint16_t XY(uint8_t x, uint8_t y);
+
+extern CRGB leds_plus_safety_pixel[Board::LED_AMOUNT + 1];
+extern CRGB *const leds;
+extern CRGBSet leds_set;
+extern CRGBSet stateled;
+extern CRGBSet matrixleds;
+extern CRGBSet sliderleds;
+
+// Layers, composed into matrixleds and sliderleds by LedManager::Show.
+// Matrix layers are in LED order and end with a safety pixel for off-matrix writes.
+extern CRGB markerleds[Matrix::SIZE + 1];
+extern CRGB patternleds[Matrix::SIZE + 1];
+extern CRGB feedbackleds[Matrix::SIZE + 1];
+extern CRGB sliderlayer[Slider::LENGTH];
+
+#endif // LEDBUFFERS_HPP
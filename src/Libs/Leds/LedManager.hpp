@@ -4,47 +4,24 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include "pinout.h"
-
-#define kMatrixWidth 4  // Matrix width [4]
-#define kMatrixHeight 4 // Matrix height [4]
-#define sliderLength 7
-#define NUM_LEDS (kMatrixWidth * kMatrixHeight + sliderLength + 1)
-
-uint16_t XY(uint8_t x, uint8_t y)
+#include "Compositor.hpp"
+#include "LedOutput.hpp"
+#include "Geometry.hpp"
+#include "LedBuffers.hpp"
+
+// Shorthands for the board geometry, see Geometry.hpp
+#define kMatrixWidth Matrix::WIDTH
+#define kMatrixHeight Matrix::HEIGHT
+#define sliderLength Slider::LENGTH
+#define NUM_LEDS Board::LED_AMOUNT
+#define LED_FRAME_RATE 60 // default render rate in Hz
+
+// LED of a key, keys are numbered row by row like the matrix coordinates
+constexpr uint16_t KeyLed(uint8_t key)
 {
-    if (x >= kMatrixWidth)
-        return -1;
-    if (y >= kMatrixHeight)
-        return -1;
-
-    uint16_t i;
-
-    i = (y * kMatrixWidth) + x;
-
-    return i;
+    return Matrix::Index(key % Matrix::WIDTH, key / Matrix::WIDTH);
 }
 
-#ifndef REV_B
-
-CRGB leds_plus_safety_pixel[NUM_LEDS + 1];
-CRGB *const leds(leds_plus_safety_pixel + 1);
-CRGBSet leds_set(leds, NUM_LEDS);
-CRGBSet stateled(leds_set(0, 0));
-CRGBSet matrixleds(leds_set(1, 16));
-CRGB patternleds[16];
-CRGBSet sliderleds(leds_set(17, 23));
-#endif// LEDMANAGER_HPP
-
-#ifdef REV_B
-CRGB leds_plus_safety_pixel[NUM_LEDS + 1];
-CRGB *const leds(leds_plus_safety_pixel + 1);
-CRGBSet leds_set(leds, NUM_LEDS);
-CRGBSet stateled(leds_set(0, 0));
-CRGBSet sliderleds(leds_set(1, 7));
-CRGBSet matrixleds(leds_set(8, 16));
-CRGB patternleds[16];
-#endif// LEDMANAGER_HPP
-
 #include "patterns/Droplet.hpp"
 #include "patterns/Sea.hpp"
 #include "patterns/Sea2.hpp"
@@ -54,6 +31,7 @@ CRGB patternleds[16];
 #include "patterns/Strips.hpp"
 #include "patterns/Strum.hpp"
 #include "patterns/QuickSettings.hpp"
+#include "patterns/Ripples.hpp"
 
 class LedManager
 {
@@ -61,19 +39,27 @@ public:
     LedManager(){};
     void Init()
     {
-        FastLED.addLeds<WS2812B, PIN_LED, GRB>(leds, NUM_LEDS);
+        // FastLED transmits from the output's front buffer, everything else renders into leds
+        FastLED.addLeds<WS2812B, PIN_LED, GRB>(output.GetFront(), NUM_LEDS);
         FastLED.setCorrection(TypicalLEDStrip);
         FastLED.setTemperature(Candle);
         FastLED.setDither(0);
-        FastLED.setBrightness(170);
+        FastLED.setBrightness(brightness);
+        fill_solid(output.GetFront(), NUM_LEDS, CRGB::Black);
         fill_solid(leds, NUM_LEDS, CRGB::Black);
 
+        // markers at the bottom, the pattern brightens them, feedback goes on top of both
+        matrix.SetLayer(MARKER_LAYER, markerleds, BlendMode::NORMAL);
+        matrix.SetLayer(PATTERN_LAYER, patternleds, BlendMode::SCREEN);
+        matrix.SetLayer(FEEDBACK_LAYER, feedbackleds, BlendMode::ADD);
+        slider.SetLayer(0, sliderlayer, BlendMode::NORMAL);
+
         FastLED.show();
+        output.Start();
         // STARTUP ANIMATION
         // StartupAnimation();
-        // currentPattern = new NoBlur();
-        currentPattern = new TouchBlur();
-        // basePattern = new Sea2();
+        currentPattern = &startPattern;
+        nextPattern = &startPattern;
     }
 
     void SetMarker(uint8_t idx, bool state)
@@ -86,40 +72,100 @@ public:
     void SetLed(uint8_t idx, bool state)
     {
         if (state)
-            matrixleds[idx] = CHSV(HUE_ORANGE, 230, 70);
+            feedbackleds[KeyLed(idx)] = CHSV(HUE_ORANGE, 230, 70);
         else
-            matrixleds[idx] = CRGB::Black;
+            feedbackleds[KeyLed(idx)] = CRGB::Black;
     }
 
     void DrawMarkers()
     {
-        for (uint8_t i = 0; i < 16; i++)
+        for (uint8_t i = 0; i < Matrix::SIZE; i++)
         {
             if (is_marker[i])
             {
-                matrixleds[i] = ColorFromPalette(Pattern::currentPalette, 0, 64);
+                markerleds[KeyLed(i)] = Pattern::PaletteColor(0, 64);
             }
 
             else
             {
-                matrixleds[i] = CRGB::Black;
+                markerleds[KeyLed(i)] = CRGB::Black;
             }
         }
     }
 
+    void ClearMarkers()
+    {
+        fill_solid(markerleds, Matrix::SIZE, CRGB::Black);
+    }
+
     void SetBrightness(uint8_t brightness)
     {
-        FastLED.setBrightness(brightness);
+        this->brightness = brightness;
     }
 
-    void RunPattern()
+    // Renders and sends a frame when one is due at the frame rate, call it every loop
+    void Render()
     {
-        if (!currentPattern->RunPattern())
+        ulong now = millis();
+        ulong elapsed = now - lastFrame;
+        if (elapsed < framePeriod)
+        {
+            return;
+        }
+        lastFrame = now;
+        // a stalled loop shouldn't make the animations jump
+        RunPattern(elapsed > 100 ? 100 : elapsed);
+        Show();
+    }
+
+    void SetFrameRate(uint8_t fps)
+    {
+        framePeriod = 1000 / (fps > 0 ? fps : 1);
+    }
+
+    void RunPattern(uint16_t dt)
+    {
+        uint32_t start = ESP.getCycleCount();
+        Pattern::UpdatePaletteFade(dt);
+        if (!currentPattern->RunPattern(dt))
         {
             currentPattern = nextPattern;
         }
-        CombineBuffers();
+        UpdatePatternStats(ESP.getCycleCount() - start);
     };
+
+    // Average CPU cycles the current pattern takes to render a frame, and frames rendered, over the last second
+    uint32_t GetPatternCycles() { return patternCycles; };
+    uint32_t GetPatternFrames() { return patternFrames; };
+
+    LedOutput<NUM_LEDS> &GetOutput() { return output; };
+
+    // Composes the layers and sends the frame out, unless it is identical to the last one sent
+    void Show()
+    {
+        matrix.Compose(matrixleds, Matrix::SIZE);
+        slider.Compose(sliderleds, sliderLength);
+
+        uint32_t hash = Compositor<1>::Hash(leds, NUM_LEDS, brightness);
+        if (hash == frameHash && !forceShow)
+        {
+            return;
+        }
+        frameHash = hash;
+        forceShow = false;
+        output.Submit(leds, brightness);
+    }
+
+    void SetLayerOpacity(uint8_t layer, uint8_t opacity)
+    {
+        matrix.SetOpacity(layer, opacity);
+    }
+
+    void SetLayerBlendMode(uint8_t layer, BlendMode mode)
+    {
+        matrix.SetBlendMode(layer, mode);
+    }
+
     void SetPosition(uint8_t x, uint8_t y)
     {
         currentPattern->SetPosition(x, y);
@@ -135,6 +181,22 @@ public:
         currentPattern->SetStrip(strip, value);
     }
 
+    // Notes go to the pattern coming in while a transition runs, so no release is lost on the way
+    void NoteOn(uint8_t idx, uint8_t velocity)
+    {
+        NoteTarget()->Trigger(idx % kMatrixWidth, idx / kMatrixWidth, velocity);
+    }
+
+    void NoteOff(uint8_t idx)
+    {
+        NoteTarget()->Release(idx % kMatrixWidth, idx / kMatrixWidth);
+    }
+
+    void NotePressure(uint8_t idx, uint8_t pressure)
+    {
+        NoteTarget()->SetPressure(idx % kMatrixWidth, idx / kMatrixWidth, pressure);
+    }
+
     void SetState(bool state)
     {
         currentPattern->SetState(state);
@@ -178,7 +240,7 @@ public:
     void SetSlider(float value, bool fill = true, uint8_t fade = 1)
     {
         uint8_t numLedsToLight = static_cast<uint8_t>(value * (sliderLength - 1));
-        fadeToBlackBy(sliderleds, 7, fade);
+        fadeToBlackBy(sliderlayer, Slider::LENGTH, fade);
 
         for (uint8_t i = 0; i < sliderLength; i++)
         {
@@ -186,14 +248,14 @@ public:
             {
                 if (i <= numLedsToLight)
                 {
-                    sliderleds[6 - i] = CHSV(slider_color, 230, 100);
+                    sliderlayer[Slider::Index(i)] = CHSV(slider_color, 230, 100);
                 }
             }
             else
             {
                 if (i == numLedsToLight)
                 {
-                    sliderleds[6 - i] = CHSV(slider_color, 230, 100);
+                    sliderlayer[Slider::Index(i)] = CHSV(slider_color, 230, 100);
                 }
             }
         }
@@ -201,43 +263,44 @@ public:
 
     void SetSlider(uint8_t position, bool fill = false, uint8_t fade = 1)
     {
-        fadeToBlackBy(sliderleds, 7, fade);
+        fadeToBlackBy(sliderlayer, Slider::LENGTH, fade);
         if (fill)
         {
             for (uint8_t i = 0; i <= position; i++)
             {
-                sliderleds[6 - i] = CHSV(slider_color, 230, 100);
+                sliderlayer[Slider::Index(i)] = CHSV(slider_color, 230, 100);
             }
         }
         else
         {
-            sliderleds[6 - position] = CHSV(slider_color, 230, 100);
+            sliderlayer[Slider::Index(position)] = CHSV(slider_color, 230, 100);
         }
     }
 
     void SetSliderLed(uint8_t idx, uint8_t intensity, uint8_t steps = 1)
     {
-        sliderleds[6 - idx * steps] = CHSV(slider_color, 230, intensity);
+        sliderlayer[Slider::Index(idx * steps)] = CHSV(slider_color, 230, intensity);
     }
 
     void SetPattern(Pattern *pattern)
     {
+        pattern->Activate();
         currentPattern = pattern;
     }
 
     void TransitionToPattern(Pattern *pattern)
     {
+        pattern->Activate();
         nextPattern = pattern;
-        currentPattern = new WaveTransition();
+        transition.Reset(Direction::UP);
+        currentPattern = &transition;
     }
 
+    // Replays the transition into the current pattern, e.g. on bank changes
     void UpdateTransition()
     {
-        if (!nextPattern->isTransition)
-        {
-            currentPattern = nextPattern;
-        }
-        currentPattern = new WaveTransition(Direction::DOWN);
+        transition.Reset(Direction::DOWN);
+        currentPattern = &transition;
     }
 
     void SetSliderHue(uint8_t hue)
@@ -245,15 +308,16 @@ public:
         slider_color = hue;
     }
 
-    void SetPalette(CRGBPalette16 palette)
+    // Cross-fades to the palette over the next frames
+    void SetPalette(const CRGBPalette16 &palette)
     {
-        currentPattern->SetPalette(palette);
+        Pattern::FadeToPalette(palette);
     }
 
     void SetStatus(bool state)
     {
         stateled = state ? CRGB::White : CRGB::Black;
-        FastLED.show();
+        Show();
     }
 
     void TestAll()
@@ -262,9 +326,19 @@ public:
         {
             leds_set[i] = CHSV(HUE_AQUA, 230, 70);
         }
-        FastLED.show();
+        output.Submit(leds, brightness);
+        // written around the layers, the next Show has to go out whatever it contains
+        forceShow = true;
     }
 
+    enum Layer
+    {
+        MARKER_LAYER,
+        PATTERN_LAYER,
+        FEEDBACK_LAYER,
+        LAYER_AMOUNT
+    };
+
 private:
     uint8_t pos_x = 0;
     uint8_t pos_y = 0;
@@ -273,29 +347,60 @@ private:
 
     bool state = false;
 
-    Pattern *currentPattern;
-    Pattern *nextPattern;
+    // Patterns are never allocated at runtime, the transition is reused for every change
+    TouchBlur startPattern;
+    WaveTransition transition;
+    Pattern *currentPattern = &startPattern;
+    Pattern *nextPattern = &startPattern;
+
+    Pattern *NoteTarget()
+    {
+        return currentPattern == &transition ? nextPattern : currentPattern;
+    }
 
-    void CombineBuffers()
+    void UpdatePatternStats(uint32_t cycles)
     {
-        for (uint8_t i = 0; i < 16; i++)
+        statsCycles += cycles;
+        statsFrames++;
+        ulong now = millis();
+        if (now - statsStart >= 1000)
         {
-            matrixleds[i] |= patternleds[i];
+            patternCycles = statsCycles / statsFrames;
+            patternFrames = statsFrames;
+            statsStart = now;
+            statsCycles = 0;
+            statsFrames = 0;
         }
     }
 
     void StartupAnimation()
     {
-        for (uint8_t i = 0; i < 16; i++)
+        for (uint8_t i = 0; i < Matrix::SIZE; i++)
         {
-            matrixleds[i] = CHSV(HUE_ORANGE, 230, 70);
-            FastLED.show();
+            matrixleds[KeyLed(i)] = CHSV(HUE_ORANGE, 230, 70);
+            output.Submit(leds, brightness);
+            forceShow = true;
             delay(10);
         }
     }
 
     uint8_t slider_color = HUE_ORANGE;
-    bool is_marker[16] = {false};
+    bool is_marker[Matrix::SIZE] = {false};
+
+    Compositor<LAYER_AMOUNT> matrix;
+    Compositor<1> slider;
+    uint32_t frameHash = 0;
+    bool forceShow = true;
+    uint8_t brightness = 170;
+    ulong lastFrame = 0;
+    uint32_t patternCycles = 0;
+    uint32_t patternFrames = 0;
+    uint64_t statsCycles = 0;
+    uint32_t statsFrames = 0;
+    ulong statsStart = 0;
+    uint16_t framePeriod = 1000 / LED_FRAME_RATE;
+
+    LedOutput<NUM_LEDS> output;
 };
 
 #endif// LEDMANAGER_HPP
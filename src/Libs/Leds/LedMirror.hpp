@@ -0,0 +1,113 @@
+#ifndef LEDMIRROR_HPP
+#define LEDMIRROR_HPP
+
+#include "LedManager.hpp"
+
+#define LED_MIRROR_RATE 10        // mirror frames per second at most
+#define LED_MIRROR_KEYFRAME 2000  // ms between full frames, so a view opened late catches up
+
+// Streams the composed LEDs to the editor as SysEx, only what changed since the last message.
+// LEDs are sent in logical order, whatever the board revision: the keys row by row, the slider from
+// position 0 up, then the status LED. Colors are 7 bit so every byte is a valid SysEx data byte.
+//
+//   127 7 7 0 r g b ...        full frame, every LED
+//   127 7 7 1 idx r g b ...    changed LEDs only
+class LedMirror
+{
+public:
+    static const uint8_t LED_AMOUNT = Matrix::SIZE + Slider::LENGTH + 1;
+    static const uint16_t MAX_MESSAGE = 4 + LED_AMOUNT * 3; // a delta never grows past a full frame
+
+    enum MessageType
+    {
+        KEYFRAME,
+        DELTA
+    };
+
+    void SetEnabled(bool enabled)
+    {
+        this->enabled = enabled;
+        // resync the view with a full frame
+        lastKeyframe = 0;
+        keyframeDue = true;
+    }
+
+    bool IsEnabled() { return enabled; };
+
+    // Builds the next message into message if one is due, returns its size or 0 when there is nothing to send
+    uint16_t Update(ulong now, uint8_t *message)
+    {
+        if (!enabled || now - lastMessage < 1000 / LED_MIRROR_RATE)
+        {
+            return 0;
+        }
+
+        uint8_t frame[LED_AMOUNT][3];
+        Capture(frame);
+
+        uint8_t changed = 0;
+        for (uint8_t i = 0; i < LED_AMOUNT; i++)
+        {
+            if (memcmp(frame[i], sent[i], 3) != 0)
+                changed++;
+        }
+
+        bool keyframe = keyframeDue || now - lastKeyframe >= LED_MIRROR_KEYFRAME || changed * 4 >= LED_AMOUNT * 3;
+        if (!keyframe && changed == 0)
+        {
+            return 0;
+        }
+
+        message[0] = 127;
+        message[1] = 7;
+        message[2] = 7;
+        message[3] = keyframe ? KEYFRAME : DELTA;
+        uint16_t size = 4;
+        for (uint8_t i = 0; i < LED_AMOUNT; i++)
+        {
+            if (!keyframe)
+            {
+                if (memcmp(frame[i], sent[i], 3) == 0)
+                    continue;
+                message[size++] = i;
+            }
+            memcpy(&message[size], frame[i], 3);
+            size += 3;
+        }
+
+        memcpy(sent, frame, sizeof(sent));
+        lastMessage = now;
+        if (keyframe)
+        {
+            lastKeyframe = now;
+            keyframeDue = false;
+        }
+        return size;
+    }
+
+private:
+    bool enabled = false;
+    bool keyframeDue = true;
+    ulong lastMessage = 0;
+    ulong lastKeyframe = 0;
+    uint8_t sent[LED_AMOUNT][3] = {};
+
+    static void Capture(uint8_t frame[LED_AMOUNT][3])
+    {
+        uint8_t i = 0;
+        for (uint8_t key = 0; key < Matrix::SIZE; key++)
+            Pack(matrixleds[KeyLed(key)], frame[i++]);
+        for (uint8_t position = 0; position < Slider::LENGTH; position++)
+            Pack(sliderleds[Slider::Index(position)], frame[i++]);
+        Pack(stateled[0], frame[i]);
+    }
+
+    static void Pack(const CRGB &color, uint8_t *out)
+    {
+        out[0] = color.r >> 1;
+        out[1] = color.g >> 1;
+        out[2] = color.b >> 1;
+    }
+};
+
+#endif // LEDMIRROR_HPP
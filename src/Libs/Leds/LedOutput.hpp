@@ -0,0 +1,132 @@
+#ifndef LEDOUTPUT_HPP
+#define LEDOUTPUT_HPP
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "../CpuMonitor.hpp"
+
+// Sends frames to the strip from its own task, so the caller never waits for the pixels to be clocked out.
+// Frames are rendered in the caller's buffer, copied into a mailbox by Submit and picked up by the task
+// into the front buffer FastLED transmits from. At most one frame is in flight, a frame submitted while
+// the previous one is still going out replaces the one waiting in the mailbox.
+template <uint16_t Size>
+class LedOutput
+{
+public:
+    // The buffer to register with FastLED.addLeds, only ever touched by the output task
+    CRGB *GetFront() { return front; };
+
+    void Start()
+    {
+        xTaskCreatePinnedToCore(LedOutput::taskUpdate, "LedOutput", 1024 * 2, this, 1, &_task, 0);
+    }
+
+    void Submit(const CRGB *pixels, uint8_t brightness)
+    {
+        ulong start = micros();
+        portENTER_CRITICAL(&lock);
+        memcpy(mailbox, pixels, sizeof(mailbox));
+        mailboxBrightness = brightness;
+        if (pending)
+        {
+            dropped++;
+        }
+        pending = true;
+        portEXIT_CRITICAL(&lock);
+        xTaskNotifyGive(_task);
+        ulong elapsed = micros() - start;
+        // the output task resets the counters from the other core
+        portENTER_CRITICAL(&lock);
+        submitTime += elapsed;
+        submitted++;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // Average us the caller spends handing over a frame
+    float GetSubmitTime() { return submitAverage; };
+    // Average us FastLED.show() takes, which is what the caller used to block for
+    float GetShowTime() { return showAverage; };
+    // Frames shown, and frames replaced in the mailbox before the output task got to them, over the last second
+    uint32_t GetShownFrames() { return shownFrames; };
+    uint32_t GetReplacedFrames() { return replacedFrames; };
+
+    static void taskUpdate(void *pvParameters)
+    {
+        LedOutput *output = static_cast<LedOutput *>(pvParameters);
+        while (1)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            CpuSection section(CpuMonitor::LEDS);
+            output->Transmit();
+        }
+    }
+
+private:
+    CRGB front[Size];
+    CRGB mailbox[Size];
+    uint8_t mailboxBrightness = 255;
+    bool pending = false;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t _task;
+
+    // Stats, submit side written by the caller and reset by the output task, both under lock.
+    // Show side only touched by the output task.
+    ulong submitTime = 0;
+    uint32_t submitted = 0;
+    uint32_t dropped = 0;
+    float submitAverage = 0.0f;
+    float showAverage = 0.0f;
+    uint32_t shownFrames = 0;
+    uint32_t replacedFrames = 0;
+    ulong showTime = 0;
+    uint32_t shown = 0;
+    ulong statsStart = 0;
+
+    void Transmit()
+    {
+        uint8_t brightness;
+        portENTER_CRITICAL(&lock);
+        if (!pending)
+        {
+            portEXIT_CRITICAL(&lock);
+            return;
+        }
+        memcpy(front, mailbox, sizeof(front));
+        brightness = mailboxBrightness;
+        pending = false;
+        portEXIT_CRITICAL(&lock);
+
+        ulong start = micros();
+        FastLED.setBrightness(brightness);
+        FastLED.show();
+        showTime += micros() - start;
+        shown++;
+        UpdateStats();
+    }
+
+    void UpdateStats()
+    {
+        ulong now = millis();
+        if (now - statsStart < 1000)
+        {
+            return;
+        }
+        portENTER_CRITICAL(&lock);
+        uint32_t count = submitted;
+        ulong time = submitTime;
+        replacedFrames = dropped;
+        submitTime = 0;
+        submitted = 0;
+        dropped = 0;
+        portEXIT_CRITICAL(&lock);
+
+        showAverage = (float)showTime / shown;
+        submitAverage = count > 0 ? (float)time / count : 0.0f;
+        shownFrames = shown;
+        statsStart = now;
+        showTime = 0;
+        shown = 0;
+    }
+};
+
+#endif // LEDOUTPUT_HPP
@@ -0,0 +1,13 @@
+#ifndef PALETTES_HPP
+#define PALETTES_HPP
+
+#include <FastLED.h>
+
+DEFINE_GRADIENT_PALETTE(unwn_gp){0, 255, 246, 197, 128, 255, 178, 28, 255, 255, 83, 0};
+// DEFINE_GRADIENT_PALETTE(unwn_gp){0, 176, 65, 251, 127, 230, 2, 2, 255, 255, 111, 156};
+DEFINE_GRADIENT_PALETTE(topo_gp){0, 0, 107, 189, 128, 255, 147, 0, 255, 0, 255, 121};
+DEFINE_GRADIENT_PALETTE(alt_gp){0, 189, 70, 70, 255, 78, 75, 232};
+DEFINE_GRADIENT_PALETTE(acid_gp){0, 126, 255, 36, 255, 130, 0, 255};
+CRGBPalette16 palette[] = {unwn_gp, topo_gp, alt_gp, acid_gp};
+
+#endif // PALETTES_HPP
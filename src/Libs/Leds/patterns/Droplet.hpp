@@ -7,7 +7,7 @@ class Drops : public Pattern
 {
 public:
     Drops();
-    bool RunPattern() override;
+    bool RunPattern(uint16_t dt) override;
 
     void SetPosition(uint8_t x, uint8_t y) override
     {
@@ -22,46 +22,54 @@ public:
     };
 
 private:
+    // Rings of drops near the edges run off the matrix, those pixels are skipped
+    static void Plot(int16_t x, int16_t y, const CRGB &color)
+    {
+        if (Matrix::Contains(x, y))
+            patternleds[Matrix::Index(x, y)] = color;
+    }
+
     void DrawCircle(int16_t x0, int16_t y0, int16_t r, CRGB color);
 
     uint8_t radius = 0;
     uint8_t colorIndex = 255;
+    FrameTimer growTimer;
 };
 
 Drops::Drops()
 {
-    currentPalette = unwn_gp;
+    SetPalette(unwn_gp);
 }
 
-bool Drops::RunPattern()
+bool Drops::RunPattern(uint16_t dt)
 {
 
     int8_t spawnX = pos_x;
     int8_t spawnY = pos_y;
 
-    CRGB color = ColorFromPalette(currentPalette, colorIndex, 255, LINEARBLEND_NOWRAP);
+    CRGB color = PaletteColor(colorIndex);
 
-    fadeToBlackBy(patternleds, NUM_LEDS, 2);
+    fadeToBlackBy(patternleds, Matrix::SIZE, PerFrame(2, dt));
 
     if (state)
     {
         if (radius == 0)
         {
-            patternleds[XY(spawnX, spawnY)] = color;
+            Plot(spawnX, spawnY, color);
             radius++;
         }
         else if (radius < 4)
         {
-            patternleds[XY(spawnX, spawnY)] = color;
-            EVERY_N_MILLIS(50)
+            Plot(spawnX, spawnY, color);
+            if (growTimer.Tick(dt, 50))
             {
                 colorIndex -= 2;
                 for (uint8_t i = 1; i <= radius; i++)
                 {
-                    patternleds[XY(spawnX - i, spawnY)] = color;
-                    patternleds[XY(spawnX + i, spawnY)] = color;
-                    patternleds[XY(spawnX, spawnY - i)] = color;
-                    patternleds[XY(spawnX, spawnY + i)] = color;
+                    Plot(spawnX - i, spawnY, color);
+                    Plot(spawnX + i, spawnY, color);
+                    Plot(spawnX, spawnY - i, color);
+                    Plot(spawnX, spawnY + i, color);
                 }
                 radius++;
             }
@@ -84,10 +92,10 @@ void Drops::DrawCircle(int16_t x0, int16_t y0, int16_t r, CRGB color)
     int16_t x = 0;
     int16_t y = r;
 
-    patternleds[XY(x0, y0 + r)] = color;
-    patternleds[XY(x0, y0 - r)] = color;
-    patternleds[XY(x0 + r, y0)] = color;
-    patternleds[XY(x0 - r, y0)] = color;
+    Plot(x0, y0 + r, color);
+    Plot(x0, y0 - r, color);
+    Plot(x0 + r, y0, color);
+    Plot(x0 - r, y0, color);
 
     while (x < y)
     {
@@ -101,14 +109,14 @@ void Drops::DrawCircle(int16_t x0, int16_t y0, int16_t r, CRGB color)
         ddF_x += 2;
         f += ddF_x;
 
-        patternleds[x0 + x, y0 + y] = color;
-        patternleds[x0 - x, y0 + y] = color;
-        patternleds[x0 + x, y0 - y] = color;
-        leds[x0 - x, y0 - y] = color;
-        leds[x0 + y, y0 + x] = color;
-        leds[x0 - y, y0 + x] = color;
-        leds[x0 + y, y0 - x] = color;
-        leds[x0 - y, y0 - x] = color;
+        Plot(x0 + x, y0 + y, color);
+        Plot(x0 - x, y0 + y, color);
+        Plot(x0 + x, y0 - y, color);
+        Plot(x0 - x, y0 - y, color);
+        Plot(x0 + y, y0 + x, color);
+        Plot(x0 - y, y0 + x, color);
+        Plot(x0 + y, y0 - x, color);
+        Plot(x0 - y, y0 - x, color);
     }
 }
 
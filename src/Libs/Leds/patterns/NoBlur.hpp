@@ -8,10 +8,10 @@ class NoBlur : public Pattern
 public:
     NoBlur()
     {
-        currentPalette = topo_gp;
+        SetPalette(topo_gp);
         GenerateLut();
     };
-    bool RunPattern() override;
+    bool RunPattern(uint16_t dt) override;
 
     void SetPosition(uint8_t x, uint8_t y) override
     {
@@ -37,33 +37,35 @@ private:
 
     void GenerateLut()
     {
-        // generate brightness lookup table for the blur (using blur2d), in a 4x4 grid.
-        CRGB lumaleds[16];
-        fill_solid(lumaleds, 16, CRGB::Black);
-        lumaleds[0] = CRGB::White;
+        // generate brightness lookup table for the blur (using blur2d), over the whole matrix.
+        // blur2d goes through XY(), so the table is in LED order like the layers.
+        CRGB lumaleds[Matrix::SIZE];
+        fill_solid(lumaleds, Matrix::SIZE, CRGB::Black);
+        lumaleds[Matrix::Index(0, 0)] = CRGB::White;
 
         // blur, then store luma values inside the luma array for each led
         for (int j = 0; j < 10; j++)
         {
-            blur2d(lumaleds, 4, 4, 2 + j * 4);
-            lumaleds[0] = CRGB::White;
-            for (int i = 0; i < 16; i++)
+            blur2d(lumaleds, kMatrixWidth, kMatrixHeight, 2 + j * 4);
+            lumaleds[Matrix::Index(0, 0)] = CRGB::White;
+            for (int i = 0; i < Matrix::SIZE; i++)
             {
                 luma[j][i] = brighten8_raw(lumaleds[i].getLuma());
             }
         }
     };
 
-    uint8_t luma[10][16] = {0};
+    uint8_t luma[10][Matrix::SIZE] = {0};
     uint8_t speed = 10;
-    ulong lastMillis = 0;
+    uint16_t stepTime = 0;
+    FrameTimer blurTimer;
 };
 
-bool NoBlur::RunPattern()
+bool NoBlur::RunPattern(uint16_t dt)
 {
-    EVERY_N_MILLIS(20)
+    if (blurTimer.Tick(dt, 20))
     {
-        blur2d(patternleds, 4, 4, 40);
+        blur2d(patternleds, kMatrixWidth, kMatrixHeight, 40);
     }
     // based on the current position, get the luma value from the lookup table and use it to set the color brightness for the LED
     // the luma array has its center on 0,0, so we need to treat it as the center (pos_x, pos_y) and then mirror it in every direction.
@@ -76,20 +78,21 @@ bool NoBlur::RunPattern()
         }
         else
         {
-            for (int x = 0; x < 4; x++)
+            for (int x = 0; x < kMatrixWidth; x++)
             {
-                for (int y = 0; y < 4; y++)
+                for (int y = 0; y < kMatrixHeight; y++)
                 {
-                    uint8_t luma_value = luma[step][abs(x - (uint8_t)pos_x) + abs(y - (uint8_t)pos_y) * 4];
-                    patternleds[XY(x, y)] |= ColorFromPalette(currentPalette, colorIndex, luma_value, LINEARBLEND_NOWRAP);
+                    uint8_t luma_value = luma[step][Matrix::Index(abs(x - (uint8_t)pos_x), abs(y - (uint8_t)pos_y))];
+                    patternleds[Matrix::Index(x, y)] |= PaletteColor(colorIndex, luma_value);
                 }
             }
 
-            if (millis() - lastMillis > speed)
+            stepTime += dt;
+            if (stepTime > speed)
             {
                 step++;
-                patternleds[XY(pos_x, pos_y)] = ColorFromPalette(currentPalette, colorIndex, 255, LINEARBLEND_NOWRAP);
-                lastMillis = millis();
+                patternleds[XY(pos_x, pos_y)] = PaletteColor(colorIndex);
+                stepTime = 0;
             }
         }
     }
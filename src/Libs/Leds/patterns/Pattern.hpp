@@ -5,52 +5,87 @@
 #include <FastLED.h>
 
 #define WEIGHT(a, b) ((uint8_t)(((a) * (b) + (a) + (b)) >> 8))
+#define PALETTE_FADE_TIME 400   // ms for a palette cross-fade
+#define PALETTE_FADE_SEGMENTS 4 // lookup table segments refreshed per frame while fading
 
-void wu_pixel(uint32_t x, uint32_t y, CRGB *col)
+// Weights of the four pixels around a point, from the 8 bit fractional parts of its position.
+// Every point sharing the same fractional offset can reuse them.
+struct WuWeights
 {
-    // extract the fractional parts and derive their inverses
-    uint8_t xx = x & 0xff, yy = y & 0xff, ix = 255 - xx, iy = 255 - yy;
-    uint8_t wu[4] = {WEIGHT(ix, iy), WEIGHT(xx, iy),
-                     WEIGHT(ix, yy), WEIGHT(xx, yy)};
-    // multiply the intensities by the colour, and saturating-add them to the pixels
-    for (uint8_t i = 0; i < 4; i++)
-    {
-        uint16_t xy = XY((x >> 8) + (i & 1), (y >> 8) + ((i >> 1) & 1));
+    uint8_t w[4];
+};
 
-        patternleds[xy].r = qadd8(patternleds[xy].r, (col->r * wu[i]) >> 8);
-        patternleds[xy].g = qadd8(patternleds[xy].g, (col->g * wu[i]) >> 8);
-        patternleds[xy].b = qadd8(patternleds[xy].b, (col->b * wu[i]) >> 8);
+WuWeights wu_weights(uint8_t fx, uint8_t fy)
+{
+    uint8_t ix = 255 - fx, iy = 255 - fy;
+    return {{WEIGHT(ix, iy), WEIGHT(fx, iy), WEIGHT(ix, fy), WEIGHT(fx, fy)}};
+}
+
+// Saturating-adds col scaled by weight to a pattern pixel, pixels outside of the matrix are clipped
+template <typename Geometry = Matrix>
+inline void wu_add(int16_t x, int16_t y, const CRGB &col, uint8_t weight)
+{
+    if (weight == 0 || !Geometry::Contains(x, y))
+    {
+        return;
     }
+    uint16_t xy = Geometry::Index(x, y);
+    patternleds[xy].r = qadd8(patternleds[xy].r, (col.r * weight) >> 8);
+    patternleds[xy].g = qadd8(patternleds[xy].g, (col.g * weight) >> 8);
+    patternleds[xy].b = qadd8(patternleds[xy].b, (col.b * weight) >> 8);
 }
 
-void wu_pixel_1d(uint8_t x, uint32_t y, CRGB *col)
+// Anti-aliased point with its top left pixel at x, y
+template <typename Geometry = Matrix>
+void wu_pixel(uint8_t x, uint8_t y, const WuWeights &weights, const CRGB &col)
 {
-    // Extract the integer and fractional parts of y
-    uint32_t iy = y >> 8;  // Integer part
-    uint8_t fy = y & 0xFF; // Fractional part
+    wu_add<Geometry>(x, y, col, weights.w[0]);
+    wu_add<Geometry>(x + 1, y, col, weights.w[1]);
+    wu_add<Geometry>(x, y + 1, col, weights.w[2]);
+    wu_add<Geometry>(x + 1, y + 1, col, weights.w[3]);
+}
 
-    // Calculate the inverse of the fractional part
-    uint8_t ify = 255 - fy;
+// Anti-aliased point at x, y in 8.8 fixed point
+void wu_pixel(uint32_t x, uint32_t y, CRGB *col)
+{
+    wu_pixel(x >> 8, y >> 8, wu_weights(x & 0xff, y & 0xff), *col);
+}
 
-    // Calculate the weights for interpolation
-    uint8_t w[2] = {WEIGHT(ify, 255), WEIGHT(fy, 255)};
+// Anti-aliased point on column x, at y in 8.8 fixed point
+void wu_pixel_1d(uint8_t x, uint32_t y, CRGB *col)
+{
+    uint8_t iy = y >> 8;
+    uint8_t fy = y & 0xFF;
+    wu_add(x, iy, *col, WEIGHT(255 - fy, 255));
+    wu_add(x, iy + 1, *col, WEIGHT(fy, 255));
+}
+
+// Fires every period ms of accumulated frame time, owned by each pattern instance
+struct FrameTimer
+{
+    uint16_t elapsed = 0;
 
-    // Interpolate between two pixels
-    for (uint8_t i = 0; i < 2; i++)
+    bool Tick(uint16_t dt, uint16_t period)
     {
-        uint16_t xy = XY(x, iy + i); // Calculate the pixel index
-        patternleds[xy].r = qadd8(patternleds[xy].r, (col->r * w[i]) >> 8);
-        patternleds[xy].g = qadd8(patternleds[xy].g, (col->g * w[i]) >> 8);
-        patternleds[xy].b = qadd8(patternleds[xy].b, (col->b * w[i]) >> 8);
+        elapsed += dt;
+        if (elapsed < period)
+        {
+            return false;
+        }
+        // don't try to catch up after long stalls
+        elapsed = elapsed >= 2 * period ? 0 : elapsed - period;
+        return true;
     }
-}
+};
 
 class Pattern
 {
 public:
     Pattern(){};
 
-    virtual bool RunPattern() = 0;
+    // dt is the time since the previous frame in ms, animations must advance by it and not per call.
+    // Returns false once a pattern (transitions) is done.
+    virtual bool RunPattern(uint16_t dt) = 0;
     virtual void SetPosition(uint8_t x, uint8_t y)
     {
         pos_x = x;
@@ -78,9 +113,87 @@ public:
 
     virtual void SetStrip(uint8_t strip, float value) {};
 
-    void SetPalette(CRGBPalette16 palette)
+    // Called when the pattern is picked to be shown, before any event reaches it. Keys held the last
+    // time it ran may have been released since.
+    virtual void Activate() {};
+
+    // Per key events, for patterns that follow every note on their own
+    virtual void Trigger(uint8_t x, uint8_t y, uint8_t velocity) {};
+    virtual void Release(uint8_t x, uint8_t y) {};
+    virtual void SetPressure(uint8_t x, uint8_t y, uint8_t pressure) {};
+
+    // Expands the palette into the lookup table, render kernels never interpolate it themselves
+    static void SetPalette(const CRGBPalette16 &palette)
     {
         currentPalette = palette;
+        for (uint16_t i = 0; i < 256; i++)
+        {
+            paletteLut[i] = ColorFromPalette(currentPalette, i, 255, LINEARBLEND_NOWRAP);
+        }
+    }
+
+    // Cross-fades from the current palette to the given one over duration ms, see UpdatePaletteFade
+    static void FadeToPalette(const CRGBPalette16 &palette, uint16_t duration = PALETTE_FADE_TIME)
+    {
+        startPalette = currentPalette;
+        targetPalette = palette;
+        fadeElapsed = 0;
+        fadeDuration = duration > 0 ? duration : 1;
+        fadeDoneSegments = 0;
+        fading = true;
+    }
+
+    // Advances the palette fade by dt. Only a few of the 16 lookup table segments are refreshed per call,
+    // round robin, so a fade costs a fraction of a full table rebuild per frame.
+    static void UpdatePaletteFade(uint16_t dt)
+    {
+        if (!fading)
+        {
+            return;
+        }
+        fadeElapsed = fadeElapsed + dt > fadeDuration ? fadeDuration : fadeElapsed + dt;
+        uint8_t progress = ((uint32_t)fadeElapsed * 255) / fadeDuration;
+
+        for (uint8_t i = 0; i < PALETTE_FADE_SEGMENTS; i++)
+        {
+            // segment s interpolates between entries s and s + 1
+            uint8_t segment = fadeSegment;
+            fadeSegment = (fadeSegment + 1) & 0x0F;
+            for (uint8_t entry = segment; entry <= segment + 1 && entry < 16; entry++)
+            {
+                currentPalette[entry] = progress == 255 ? targetPalette[entry] : blend(startPalette[entry], targetPalette[entry], progress);
+            }
+            for (uint8_t j = 0; j < 16; j++)
+            {
+                uint8_t index = segment * 16 + j;
+                paletteLut[index] = ColorFromPalette(currentPalette, index, 255, LINEARBLEND_NOWRAP);
+            }
+
+            // done once every segment has been refreshed with the final palette
+            if (progress == 255 && ++fadeDoneSegments >= 16)
+            {
+                fading = false;
+                return;
+            }
+        }
+    }
+
+    // Same result as ColorFromPalette(currentPalette, index, brightness, LINEARBLEND_NOWRAP)
+    static CRGB PaletteColor(uint8_t index, uint8_t brightness = 255)
+    {
+        if (brightness == 0)
+        {
+            return CRGB::Black;
+        }
+        CRGB color = paletteLut[index];
+        if (brightness != 255)
+        {
+            // ColorFromPalette rounds the same way
+            color.r = scale8(color.r, brightness + 1);
+            color.g = scale8(color.g, brightness + 1);
+            color.b = scale8(color.b, brightness + 1);
+        }
+        return color;
     }
 
     static CRGBPalette16 currentPalette;
@@ -88,15 +201,39 @@ public:
     bool isTransition = false;
 
 protected:
+    // Frame based amounts (fades, steps) are tuned for this frame time and scaled by dt
+    static const uint16_t REFERENCE_FRAME = 16;
+
+    static uint8_t PerFrame(uint8_t amount, uint16_t dt)
+    {
+        uint32_t scaled = ((uint32_t)amount * dt + REFERENCE_FRAME / 2) / REFERENCE_FRAME;
+        return scaled > 255 ? 255 : (scaled == 0 ? 1 : scaled);
+    }
+
     uint8_t pos_x = 0;
     uint8_t pos_y = 0;
     float amount = 0.0f;
     bool state = false;
 
     static CRGBPalette16 targetPalette;
+    static CRGBPalette16 startPalette;
+    static CRGB paletteLut[256];
+
+    static uint16_t fadeElapsed;
+    static uint16_t fadeDuration;
+    static uint8_t fadeSegment;
+    static uint8_t fadeDoneSegments;
+    static bool fading;
 };
 
 CRGBPalette16 Pattern::currentPalette(CRGB::Black);
 CRGBPalette16 Pattern::targetPalette(CRGB::Black);
+CRGBPalette16 Pattern::startPalette(CRGB::Black);
+CRGB Pattern::paletteLut[256];
+uint16_t Pattern::fadeElapsed = 0;
+uint16_t Pattern::fadeDuration = PALETTE_FADE_TIME;
+uint8_t Pattern::fadeSegment = 0;
+uint8_t Pattern::fadeDoneSegments = 0;
+bool Pattern::fading = false;
 
 #endif // PATTERN_HPP
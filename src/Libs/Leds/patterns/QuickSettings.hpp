@@ -8,9 +8,9 @@ class QuickSettings : public Pattern
 public:
     QuickSettings()
     {
-        currentPalette = topo_gp;
+        SetPalette(topo_gp);
     }
-    bool RunPattern() override;
+    bool RunPattern(uint16_t dt) override;
 
     void SetLed(uint8_t x, uint8_t y, bool state = true) override
     {
@@ -36,24 +36,24 @@ private:
     uint8_t colorIndex = 255;
 };
 
-bool QuickSettings::RunPattern()
+bool QuickSettings::RunPattern(uint16_t dt)
 {
-    fill_solid(patternleds, 16, CRGB::Black);
-    CRGB optionColor = ColorFromPalette(currentPalette, 1, 255, LINEARBLEND_NOWRAP);
-    CRGB optionDimColor = ColorFromPalette(currentPalette, 40, 20, LINEARBLEND_NOWRAP);
+    fill_solid(patternleds, Matrix::SIZE, CRGB::Black);
+    CRGB optionColor = PaletteColor(1);
+    CRGB optionDimColor = PaletteColor(40, 20);
 
-    CRGB valueColor = ColorFromPalette(currentPalette, 255, 255, LINEARBLEND_NOWRAP);
-    CRGB valueDimColor = ColorFromPalette(currentPalette, 160, 20, LINEARBLEND_NOWRAP);
+    CRGB valueColor = PaletteColor(255);
+    CRGB valueDimColor = PaletteColor(160, 20);
 
     for (uint8_t i = 0; i < 4; i++)
     {
         if (i == selectedOption)
         {
-            patternleds[i] = optionColor;
+            patternleds[KeyLed(i)] = optionColor;
         }
         else
         {
-            patternleds[i] = optionDimColor;
+            patternleds[KeyLed(i)] = optionDimColor;
         }
     }
 
@@ -65,11 +65,11 @@ bool QuickSettings::RunPattern()
         {
             if (i == selectedValue)
             {
-                patternleds[4 + i] = valueColor;
+                patternleds[KeyLed(4 + i)] = valueColor;
             }
             else
             {
-                patternleds[4 + i] = valueDimColor;
+                patternleds[KeyLed(4 + i)] = valueDimColor;
             }
         }
     }
@@ -0,0 +1,180 @@
+#ifndef RIPPLES_HPP
+#define RIPPLES_HPP
+
+#include "Pattern.hpp"
+
+#define RIPPLE_AMOUNT 16
+
+// 8.8 distance between two pixels of the matrix, by dx and dy, rounded to the nearest step
+struct RippleDistances
+{
+    uint16_t d[kMatrixWidth][kMatrixHeight];
+};
+
+constexpr RippleDistances GenerateRippleDistances()
+{
+    RippleDistances table{};
+    for (uint8_t dx = 0; dx < kMatrixWidth; dx++)
+    {
+        for (uint8_t dy = 0; dy < kMatrixHeight; dy++)
+        {
+            uint32_t square = (uint32_t)(dx * dx + dy * dy) << 16;
+            // integer square root, one bit at a time from the top
+            uint32_t root = 0;
+            for (uint32_t bit = 1UL << 15; bit > 0; bit >>= 1)
+            {
+                if ((root | bit) * (root | bit) <= square)
+                    root |= bit;
+            }
+            table.d[dx][dy] = square - root * root > root ? root + 1 : root;
+        }
+    }
+    return table;
+}
+
+// Every note spawns its own ripple from a fixed pool, so chords show all of their notes.
+// A held key keeps glowing with its pressure, the ring expands and fades once it is released.
+class Ripples : public Pattern
+{
+public:
+    Ripples()
+    {
+        state = true;
+    };
+
+    bool RunPattern(uint16_t dt) override;
+
+    // Releases missed while another pattern ran would leave their ripples glowing, let them all fade
+    void Activate() override
+    {
+        for (uint8_t i = 0; i < RIPPLE_AMOUNT; i++)
+            ripples[i].held = false;
+    };
+
+    void Trigger(uint8_t x, uint8_t y, uint8_t velocity) override
+    {
+        Ripple &ripple = Spawn(x, y);
+        ripple.x = x;
+        ripple.y = y;
+        ripple.velocity = velocity > 127 ? 127 : velocity;
+        ripple.color = 255 - ripple.velocity * 2;
+        ripple.radius = 0;
+        ripple.life = 255;
+        ripple.pressure = 0;
+        ripple.held = true;
+    };
+
+    void Release(uint8_t x, uint8_t y) override
+    {
+        Ripple *ripple = Find(x, y);
+        if (ripple)
+            ripple->held = false;
+    };
+
+    void SetPressure(uint8_t x, uint8_t y, uint8_t pressure) override
+    {
+        Ripple *ripple = Find(x, y);
+        if (ripple)
+            ripple->pressure = pressure > 127 ? 127 : pressure;
+    };
+
+private:
+    struct Ripple
+    {
+        uint8_t x, y;
+        uint8_t velocity; // 0..127, scales the whole ripple
+        uint8_t pressure; // 0..127, keeps a held ripple alive
+        uint8_t color;
+        uint8_t life;    // 0 is a free slot
+        uint16_t radius; // 8.8 pixels
+        bool held;
+    };
+
+    static const uint16_t GROWTH = 5;          // pixels per second
+    static const uint8_t FADE = 6;             // life lost per reference frame once released
+    static constexpr RippleDistances distance = GenerateRippleDistances();
+    // the ring has left the farthest corner of the matrix
+    static constexpr uint16_t MAX_RADIUS = distance.d[kMatrixWidth - 1][kMatrixHeight - 1] + 256;
+
+    static_assert(kMatrixWidth <= 64 && kMatrixHeight <= 64, "8.8 radius overflows past 64 pixels");
+
+    Ripple ripples[RIPPLE_AMOUNT] = {};
+
+    Ripple *Find(uint8_t x, uint8_t y)
+    {
+        for (uint8_t i = 0; i < RIPPLE_AMOUNT; i++)
+        {
+            if (ripples[i].life > 0 && ripples[i].x == x && ripples[i].y == y)
+                return &ripples[i];
+        }
+        return nullptr;
+    }
+
+    // Retriggers the ripple of the same key, or takes a free slot, or steals the faintest one
+    Ripple &Spawn(uint8_t x, uint8_t y)
+    {
+        Ripple *same = Find(x, y);
+        if (same)
+            return *same;
+
+        Ripple *faintest = &ripples[0];
+        for (uint8_t i = 0; i < RIPPLE_AMOUNT; i++)
+        {
+            if (ripples[i].life == 0)
+                return ripples[i];
+            if (ripples[i].life < faintest->life)
+                faintest = &ripples[i];
+        }
+        return *faintest;
+    }
+};
+
+bool Ripples::RunPattern(uint16_t dt)
+{
+    fill_solid(patternleds, Matrix::SIZE, CRGB::Black);
+
+    uint16_t growth = (GROWTH * 256UL * dt) / 1000;
+    uint8_t fade = PerFrame(FADE, dt);
+
+    for (uint8_t i = 0; i < RIPPLE_AMOUNT; i++)
+    {
+        Ripple &ripple = ripples[i];
+        if (ripple.life == 0)
+            continue;
+
+        if (ripple.radius < MAX_RADIUS)
+            ripple.radius += growth;
+        if (!ripple.held)
+            ripple.life = qsub8(ripple.life, fade);
+        if (ripple.life == 0)
+            continue;
+
+        uint8_t intensity = scale8(ripple.life, ripple.velocity * 2 + 1);
+        uint8_t glow = ripple.held ? ripple.pressure * 2 : 0;
+
+        for (uint8_t x = 0; x < kMatrixWidth; x++)
+        {
+            for (uint8_t y = 0; y < kMatrixHeight; y++)
+            {
+                uint16_t d = distance.d[abs(x - ripple.x)][abs(y - ripple.y)];
+                // one pixel wide ring, linearly falling off on both sides
+                uint16_t offset = d > ripple.radius ? d - ripple.radius : ripple.radius - d;
+                uint8_t brightness = offset >= 256 ? 0 : scale8(255 - offset, intensity);
+                if (d == 0)
+                    brightness = qadd8(brightness, glow);
+                if (brightness == 0)
+                    continue;
+
+                CRGB color = PaletteColor(ripple.color, brightness);
+                uint16_t xy = Matrix::Index(x, y);
+                patternleds[xy].r = qadd8(patternleds[xy].r, color.r);
+                patternleds[xy].g = qadd8(patternleds[xy].g, color.g);
+                patternleds[xy].b = qadd8(patternleds[xy].b, color.b);
+            }
+        }
+    }
+
+    return true;
+}
+
+#endif // RIPPLES_HPP
@@ -18,22 +18,22 @@ public:
         v_time = (uint32_t)((uint32_t)random16() << 16) + (uint32_t)random16();
         hue_time = (uint32_t)((uint32_t)random16() << 16) + (uint32_t)random16();
     };
-    bool RunPattern() override
+    bool RunPattern(uint16_t dt) override
     {
-        fadeToBlackBy(matrixleds, 16, 8);
+        fadeToBlackBy(patternleds, Matrix::SIZE, PerFrame(8, dt));
         if (state)
         {
-            fill_2dnoise8(matrixleds, kMatrixWidth, kMatrixHeight, true, octaves, x, xscale, y, yscale, v_time,
+            fill_2dnoise8(patternleds, kMatrixWidth, kMatrixHeight, true, octaves, x, xscale, y, yscale, v_time,
                           hue_octaves, hxy, hue_scale, hxy, hue_scale, hue_time, true);
         }
 
-        EVERY_N_MILLIS(100)
+        if (moveTimer.Tick(dt, 100))
         {
             x += x_speed;
             y += y_speed;
             v_time += time_speed;
         }
-        EVERY_N_MILLIS(300)
+        if (hueTimer.Tick(dt, 300))
         {
             hue_time += hue_speed;
         }
@@ -43,6 +43,7 @@ public:
 private:
     // x,y, & time values
     uint32_t x, y, v_time, hue_time, hxy;
+    FrameTimer moveTimer, hueTimer;
 
     // Play with the values of the variables below and see what kinds of effects they
     // have!  More octaves will make things slower.
@@ -12,16 +12,21 @@ public:
         x = random16();
         y = random16();
         z = random16();
-        currentPalette = unwn_gp;
+        SetPalette(unwn_gp);
     };
-    bool RunPattern() override
+    bool RunPattern(uint16_t dt) override
     {
-        fillnoise8();
-        mapNoiseToLEDsUsingPalette();
+        // Moves speed noise units per reference frame, whatever the frame rate
+        motion += dt;
+        uint16_t frames = motion / REFERENCE_FRAME;
+        motion %= REFERENCE_FRAME;
+
+        fillnoise8(frames);
+        mapNoiseToLEDsUsingPalette(frames);
         return true;
     };
 
-    void fillnoise8()
+    void fillnoise8(uint16_t frames)
     {
         // If we're runing at a low "speed", some 8-bit artifacts become visible
         // from frame-to-frame.  In order to reduce this, we can do some fast data-smoothing.
@@ -32,10 +37,10 @@ public:
             dataSmoothing = 254 - (speed * 4);
         }
 
-        for (int i = 0; i < 4; i++)
+        for (int i = 0; i < SIDE; i++)
         {
             int ioffset = scale * i;
-            for (int j = 0; j < 4; j++)
+            for (int j = 0; j < SIDE; j++)
             {
                 int joffset = scale * j;
 
@@ -57,27 +62,25 @@ public:
                 noise[i][j] = data;
             }
         }
-        z += speed;
-        x += speed / 2;
-        y -= speed / 4;
+        z += speed * frames;
+        x += speed / 2 * frames;
+        y -= speed / 4 * frames;
 
         // apply slow drift to X and Y, just for visual variation.
     }
 
-    void mapNoiseToLEDsUsingPalette()
+    void mapNoiseToLEDsUsingPalette(uint16_t frames)
     {
-        static uint8_t ihue = 0;
-
-        for (int i = 0; i < kMatrixHeight; i++)
+        for (int y = 0; y < kMatrixHeight; y++)
         {
-            for (int j = 0; j < kMatrixWidth; j++)
+            for (int x = 0; x < kMatrixWidth; x++)
             {
-                // We use the value at the (i,j) coordinate in the noise
-                // array for our brightness, and the flipped value from (j,i)
+                // We use the value at the (x,y) coordinate in the noise
+                // array for our brightness, and the flipped value from (y,x)
                 // for our pixel's index into the color palette.
 
-                uint8_t index = noise[j][i];
-                uint8_t bri = noise[i][j];
+                uint8_t index = noise[y][x];
+                uint8_t bri = noise[x][y];
 
                 // if this palette is a 'loop', add a slowly-changing base value
                 if (colorLoop)
@@ -97,12 +100,12 @@ public:
                     bri = dim8_raw(bri);
                 }
 
-                CRGB color = ColorFromPalette(currentPalette, index >> 2, bri >> 4);
-                patternleds[XY(i, j)] = color;
+                CRGB color = PaletteColor(index >> 2, bri >> 4);
+                patternleds[Matrix::Index(x, y)] = color;
             }
         }
 
-        ihue += 1;
+        ihue += frames;
     }
 
 private:
@@ -112,8 +115,12 @@ private:
 
     uint16_t speed = 1;
     uint16_t scale = 90;
-    uint8_t noise[4][4];
+    // square, the palette index reads it transposed
+    static constexpr uint8_t SIDE = kMatrixWidth > kMatrixHeight ? kMatrixWidth : kMatrixHeight;
+    uint8_t noise[SIDE][SIDE];
     uint8_t colorLoop = 0;
+    uint8_t ihue = 0;
+    uint16_t motion = 0;
 };
 
 #endif // SEA2_HPP
\ No newline at end of file
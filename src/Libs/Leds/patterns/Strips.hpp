@@ -8,14 +8,16 @@ class Strips : public Pattern
 public:
     Strips()
     {
-        currentPalette = acid_gp;
+        SetPalette(acid_gp);
         state = true;
     };
-    bool RunPattern() override;
+    bool RunPattern(uint16_t dt) override;
 
     void SetStrip(uint8_t strip, float value) override
     {
-        strips[strip] = value;
+        if (strip >= kMatrixWidth)
+            return;
+        strips[strip] = static_cast<uint32_t>(value * (1 << 8));
         state = true;
     };
 
@@ -26,20 +28,20 @@ public:
 
 private:
     uint8_t colorIndex = 255;
-    float strips[4] = {0.0f};
+    uint32_t strips[kMatrixWidth] = {0}; // one per column, 8.8 fixed point
 };
 
-bool Strips::RunPattern()
+bool Strips::RunPattern(uint16_t dt)
 {
-    fill_solid(patternleds, 16, CRGB::Black);
+    fill_solid(patternleds, Matrix::SIZE, CRGB::Black);
     if (state)
     {
 
-        CRGB color = ColorFromPalette(currentPalette, colorIndex, 255, LINEARBLEND_NOWRAP);
+        CRGB color = PaletteColor(colorIndex);
 
-        for (uint8_t i = 0; i < 4; i++)
+        for (uint8_t i = 0; i < kMatrixWidth; i++)
         {
-            wu_pixel_1d(i, static_cast<uint32_t>(strips[i] * (1 << 8)), &color);
+            wu_pixel_1d(i, strips[i], &color);
         }
     };
 
@@ -8,9 +8,9 @@ class Strum : public Pattern
 public:
     Strum()
     {
-        currentPalette = topo_gp;
+        SetPalette(topo_gp);
     }
-    bool RunPattern() override;
+    bool RunPattern(uint16_t dt) override;
 
     void SetLed(uint8_t x, uint8_t y, bool state = true) override
     {
@@ -32,37 +32,37 @@ private:
     uint8_t colorIndex = 255;
 };
 
-bool Strum::RunPattern()
+bool Strum::RunPattern(uint16_t dt)
 {
-    fill_solid(patternleds, 16, CRGB::Black);
-    CRGB noteColor = ColorFromPalette(currentPalette, colorIndex, 255, LINEARBLEND_NOWRAP);
-    CRGB noteDimColor = ColorFromPalette(currentPalette, colorIndex, 30, LINEARBLEND_NOWRAP);
+    fill_solid(patternleds, Matrix::SIZE, CRGB::Black);
+    CRGB noteColor = PaletteColor(colorIndex);
+    CRGB noteDimColor = PaletteColor(colorIndex, 30);
 
-    CRGB chordColor = ColorFromPalette(currentPalette, 1, 255, LINEARBLEND_NOWRAP);
-    CRGB chordDimColor = ColorFromPalette(currentPalette, 1, 30, LINEARBLEND_NOWRAP);
+    CRGB chordColor = PaletteColor(1);
+    CRGB chordDimColor = PaletteColor(1, 30);
 
-    for (int i = 0; i < 16; i++)
+    for (int i = 0; i < Matrix::SIZE; i++)
     {
         if (i < 12)
         {
             if (i == selectedNote)
             {
-                patternleds[i] = noteColor;
+                patternleds[KeyLed(i)] = noteColor;
             }
             else
             {
-                patternleds[i] = noteDimColor;
+                patternleds[KeyLed(i)] = noteDimColor;
             }
         }
         else
         {
             if (selectedChord == i - 12)
             {
-                patternleds[i] = chordColor;
+                patternleds[KeyLed(i)] = chordColor;
             }
             else
             {
-                patternleds[i] = chordDimColor;
+                patternleds[KeyLed(i)] = chordDimColor;
             }
         }
     }
@@ -8,18 +8,18 @@ class TouchBlur : public Pattern
 public:
     TouchBlur()
     {
-        currentPalette = unwn_gp;
+        SetPalette(unwn_gp);
         GenerateLut();
         state = true;
     };
-    bool RunPattern() override;
+    bool RunPattern(uint16_t dt) override;
 
     void SetPosition(uint8_t x, uint8_t y) override {};
 
     void SetPosition(float x, float y) override
     {
-        pos_x = x;
-        pos_y = y;
+        pos_x = ToFixed(x, kMatrixWidth);
+        pos_y = ToFixed(y, kMatrixHeight);
         state = true;
     };
 
@@ -37,21 +37,22 @@ public:
     void SetSpeed(uint8_t speed) override {};
 
 private:
-    uint8_t luma[10][16] = {0};
+    uint8_t luma[10][Matrix::SIZE] = {0};
 
     void GenerateLut()
     {
-        // generate brightness lookup table for the blur (using blur2d), in a 4x4 grid.
-        CRGB lumaleds[16];
-        fill_solid(lumaleds, 16, CRGB::Black);
-        lumaleds[0] = CRGB::White;
+        // generate brightness lookup table for the blur (using blur2d), over the whole matrix.
+        // blur2d goes through XY(), so the table is in LED order like the layers.
+        CRGB lumaleds[Matrix::SIZE];
+        fill_solid(lumaleds, Matrix::SIZE, CRGB::Black);
+        lumaleds[Matrix::Index(0, 0)] = CRGB::White;
 
         // blur, then store luma values inside the luma array for each led
         for (int j = 0; j < 10; j++)
         {
-            blur2d(lumaleds, 4, 4, 2 + j * 4);
-            lumaleds[0] = CRGB::White;
-            for (int i = 0; i < 16; i++)
+            blur2d(lumaleds, kMatrixWidth, kMatrixHeight, 2 + j * 4);
+            lumaleds[Matrix::Index(0, 0)] = CRGB::White;
+            for (int i = 0; i < Matrix::SIZE; i++)
             {
                 luma[9 - j][i] = brighten8_raw(lumaleds[i].getLuma());
             }
@@ -59,29 +60,36 @@ private:
     };
     uint8_t colorIndex = 255;
     uint8_t step = 0;
-    float pos_x = 0.0f;
-    float pos_y = 0.0f;
+    // 8.8 fixed point, kept on the matrix
+    uint16_t pos_x = 0;
+    uint16_t pos_y = 0;
+
+    // 8.8 position clamped to an axis of size pixels
+    static uint16_t ToFixed(float position, uint8_t size)
+    {
+        const uint16_t max = (size << 8) - 1;
+        if (position <= 0.0f)
+            return 0;
+        uint32_t fixed = static_cast<uint32_t>(position * (1 << 8));
+        return fixed > max ? max : fixed;
+    }
 };
 
-bool TouchBlur::RunPattern()
+bool TouchBlur::RunPattern(uint16_t dt)
 {
-    fill_solid(patternleds, 16, CRGB::Black);
+    fill_solid(patternleds, Matrix::SIZE, CRGB::Black);
     if (state)
     {
-        // Assuming step is set externally before calling this function
+        // The whole blur moves by the same sub-pixel offset, so the weights are shared by every point
+        uint8_t cx = pos_x >> 8, cy = pos_y >> 8;
+        WuWeights weights = wu_weights(pos_x & 0xFF, pos_y & 0xFF);
 
-        for (int x = 0; x < 4; x++)
+        for (uint8_t x = 0; x < kMatrixWidth; x++)
         {
-            for (int y = 0; y < 4; y++)
+            for (uint8_t y = 0; y < kMatrixHeight; y++)
             {
-                // Calculate the coordinates of the neighboring pixels
-                float new_x = (pos_x - (uint8_t)pos_x) + (float)x;
-                float new_y = (pos_y - (uint8_t)pos_y) + (float)y;
-
-                // Calculate the weight for the center pixel
-                uint8_t luma_value = luma[step][abs(x - (uint8_t)pos_x) + abs(y - (uint8_t)pos_y) * 4];
-                CRGB color = ColorFromPalette(currentPalette, colorIndex, luma_value, LINEARBLEND_NOWRAP);
-                wu_pixel(static_cast<int32_t>(new_x * (1 << 8)), static_cast<int32_t>(new_y * (1 << 8)), &color);
+                uint8_t luma_value = luma[step][Matrix::Index(abs(x - cx), abs(y - cy))];
+                wu_pixel(x, y, weights, PaletteColor(colorIndex, luma_value));
             }
         }
     }
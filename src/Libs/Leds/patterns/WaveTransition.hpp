@@ -17,22 +17,31 @@ public:
     WaveTransition(Direction dir = Direction::UP)
     {
         step = 0;
-        totalSteps = 4;
+        totalSteps = kMatrixHeight;
         direction = dir;
         isTransition = true;
     };
 
-    bool RunPattern() override;
+    bool RunPattern(uint16_t dt) override;
+
+    // Restarts the wave, the same instance is reused for every transition
+    void Reset(Direction dir)
+    {
+        step = 0;
+        stepTimer.elapsed = 0;
+        direction = dir;
+    }
 
 private:
     uint8_t step;
     uint8_t totalSteps;
     Direction direction;
+    FrameTimer stepTimer;
 };
 
-bool WaveTransition::RunPattern()
+bool WaveTransition::RunPattern(uint16_t dt)
 {
-    blur2d(patternleds, 4, 4, 200);
+    blur2d(patternleds, kMatrixWidth, kMatrixHeight, 200);
 
     int8_t xStep = 0, yStep = 0;
     switch (direction)
@@ -54,13 +63,18 @@ bool WaveTransition::RunPattern()
     int x = (xStep < 0) ? kMatrixWidth - 1 - step : step;
     int y = (yStep < 0) ? kMatrixHeight - 1 - step : step;
 
-    for (int i = 0; i < kMatrixWidth; i++)
+    // index 255 wraps around to the first palette entry, which the table doesn't cover
+    CRGB color = ColorFromPalette(currentPalette, 255);
+    // a row for vertical waves, a column for horizontal ones
+    for (int i = 0; i < (xStep ? kMatrixHeight : kMatrixWidth); i++)
     {
-        int xx = xStep ? x : i;
-        patternleds[XY(xx, y)] = ColorFromPalette(currentPalette, 255, 255);
+        patternleds[xStep ? XY(x, i) : XY(i, y)] = color;
     }
 
-    EVERY_N_MILLIS(50) { step++; }
+    if (stepTimer.Tick(dt, 50))
+    {
+        step++;
+    }
     if (step >= (xStep ? kMatrixWidth : kMatrixHeight))
     {
         step = 0;
@@ -53,11 +53,14 @@ void MidiProvider::Init(int pin_rx, int pin_tx, int pin_tx2)
 
 void MidiProvider::Read()
 {
-
-    MIDI_USB.read();
+    {
+        CpuSection section(CpuMonitor::USB);
+        MIDI_USB.read();
+    }
 
     if (midiBle)
     {
+        CpuSection section(CpuMonitor::BLE);
         MIDI_BLE.read();
     }
     if (midiThru)
@@ -69,23 +72,32 @@ void MidiProvider::Read()
 
 void MidiProvider::SendNoteOn(uint8_t key, uint8_t note, uint8_t velocity, uint8_t channel)
 {
+    TRACE_STAMP(SEND);
+    lastChannelMessage = micros();
+    CpuSection section(TransportSlot());
     note_pool[key] = note; // Save the note in the note pool at the index corresponding to the key
+    TRACE_STAMP(ENQUEUE);
     if (!midiBle)
     {
         MIDI_USB.sendNoteOn(note, velocity, channel);
+        TRACE_STAMP(USB_HANDOFF);
     }
     else
     {
         MIDI_BLE.sendNoteOn(note, velocity, channel);
+        TRACE_STAMP(BLE_HANDOFF);
     }
     if (midiOut)
     {
         MIDI_SERIAL.sendNoteOn(note, velocity, channel);
+        TRACE_STAMP(UART_HANDOFF);
     }
 }
 
 void MidiProvider::SendNoteOff(uint8_t key, uint8_t channel)
 {
+    lastChannelMessage = micros();
+    CpuSection section(TransportSlot());
     uint8_t note = note_pool[key]; // Retrieve the note from the note pool using the key
     if (!midiBle)
     {
@@ -102,79 +114,95 @@ void MidiProvider::SendNoteOff(uint8_t key, uint8_t channel)
     note_pool[key] = -1; // Clear the note from the note pool
 }
 
-void MidiProvider::SendChordOn(uint8_t key, uint8_t note, int8_t (*chord)[4], uint8_t velocity, uint8_t channel)
+// Encodes the same message for every note of a chord into one buffer. With running status only the
+// first message carries the status byte, the rest are data bytes.
+static size_t EncodeBatch(byte *buffer, midi::MidiType type, const int8_t *notes, uint8_t size, uint8_t data, uint8_t channel, bool runningStatus)
 {
-    if (note_pool[0] != -1)
-    {
-        SendChordOff(key, channel);
-    }
-    note_pool[0] = key;
-    for (int i = 1; i < 5; i++)
+    size_t length = 0;
+    for (uint8_t i = 0; i < size; i++)
     {
-        chord_pool[i] = note + (*chord)[i];
-        if (!midiBle)
+        if (notes[i] != -1)
         {
-            MIDI_USB.sendNoteOn(chord_pool[i], velocity, channel);
+            if (length == 0 || !runningStatus)
+            {
+                buffer[length++] = type | ((channel - 1) & 0x0F);
+            }
+            buffer[length++] = notes[i] & 0x7F;
+            buffer[length++] = data & 0x7F;
         }
-        else
+    }
+    return length;
+}
+
+// A chord goes out as a single write per transport rather than one MidiInterface::send() per note:
+// TinyUSB packs the whole buffer into event packets before it flushes, and BLE-MIDI sends everything
+// between beginTransmission and endTransmission as one notification, running status keeps it valid.
+void MidiProvider::SendChordMessage(midi::MidiType type, const int8_t *notes, uint8_t data, uint8_t channel)
+{
+    byte batch[MAX_CHORD_NOTES * 3];
+    lastChannelMessage = micros();
+    CpuSection section(TransportSlot());
+    TRACE_STAMP(ENQUEUE);
+    size_t length = EncodeBatch(batch, type, notes, MAX_CHORD_NOTES, data, channel, midiBle);
+    if (length == 0)
+    {
+        return;
+    }
+    if (!midiBle)
+    {
+        usb_midi.write(batch, length);
+        TRACE_STAMP(USB_HANDOFF);
+    }
+    else if (BLEMIDI.beginTransmission(type))
+    {
+        for (size_t i = 0; i < length; i++)
         {
-            MIDI_BLE.sendNoteOn(chord_pool[i], velocity, channel);
+            BLEMIDI.write(batch[i]);
         }
-        if (midiOut)
+        BLEMIDI.endTransmission();
+        TRACE_STAMP(BLE_HANDOFF);
+    }
+    if (midiOut)
+    {
+        if (midiBle)
         {
-            MIDI_SERIAL.sendNoteOn(chord_pool[i], velocity, channel);
+            length = EncodeBatch(batch, type, notes, MAX_CHORD_NOTES, data, channel, false);
         }
+        Serial2.write(batch, length);
+        TRACE_STAMP(UART_HANDOFF);
     }
 }
 
-void MidiProvider::SendChordOff(uint8_t key, uint8_t channel)
+void MidiProvider::SendChordOn(uint8_t key, uint8_t root, const int8_t *chord, uint8_t size, uint8_t velocity, uint8_t channel)
 {
-    if (note_pool[0] == key)
+    TRACE_STAMP(SEND);
+    if (chord_pool[key][0] != -1)
     {
-        for (int i = 1; i < 5; i++)
-        {
-            if (!midiBle)
-            {
-                MIDI_USB.sendNoteOff(chord_pool[i], 0, channel);
-            }
-            else
-            {
-                MIDI_BLE.sendNoteOff(chord_pool[i], 0, channel);
-            }
-            if (midiOut)
-            {
-                MIDI_SERIAL.sendNoteOff(chord_pool[i], 0, channel);
-            }
-        }
-        note_pool[0] = -1;
-        memset(chord_pool, -1, sizeof(chord_pool));
+        SendChordOff(key, channel);
     }
+    for (uint8_t i = 0; i < MAX_CHORD_NOTES; i++)
+    {
+        int16_t note = root + chord[i];
+        chord_pool[key][i] = (i < size && chord[i] != -1 && note <= 127) ? note : -1;
+    }
+    SendChordMessage(midi::NoteOn, chord_pool[key], velocity, channel);
+}
+
+void MidiProvider::SendChordOff(uint8_t key, uint8_t channel)
+{
+    SendChordMessage(midi::NoteOff, chord_pool[key], 0, channel);
+    memset(chord_pool[key], -1, sizeof(chord_pool[key]));
 }
 
 void MidiProvider::SendChordPressure(uint8_t key, uint8_t pressure, uint8_t channel)
 {
-    if (note_pool[0] == key)
-    {
-        for (int i = 1; i < 5; i++)
-        {
-            if (!midiBle)
-            {
-                MIDI_USB.sendAfterTouch(chord_pool[i], pressure, channel);
-            }
-            else
-            {
-                MIDI_BLE.sendAfterTouch(chord_pool[i], pressure, channel);
-            }
-            if (midiOut)
-            {
-                MIDI_SERIAL.sendAfterTouch(chord_pool[i], pressure, channel);
-            }
-        }
-    }
+    SendChordMessage(midi::AfterTouchPoly, chord_pool[key], pressure, channel);
 }
 
 void MidiProvider::SendChordNoteOn(uint8_t idx, uint8_t note, uint8_t velocity, uint8_t channel)
 {
+    lastChannelMessage = micros();
+    CpuSection section(TransportSlot());
     if (!midiBle)
     {
         MIDI_USB.sendNoteOn(note, velocity, channel);
@@ -192,6 +220,8 @@ void MidiProvider::SendChordNoteOn(uint8_t idx, uint8_t note, uint8_t velocity,
 
 void MidiProvider::SendChordNoteOff(uint8_t idx, uint8_t channel)
 {
+    lastChannelMessage = micros();
+    CpuSection section(TransportSlot());
     uint8_t note = strum_pool[idx]; // Retrieve the note from the note pool using the key
     if (!midiBle)
     {
@@ -210,6 +240,8 @@ void MidiProvider::SendChordNoteOff(uint8_t idx, uint8_t channel)
 
 void MidiProvider::SendAfterTouch(uint8_t key, uint8_t pressure, uint8_t channel)
 {
+    lastChannelMessage = micros();
+    CpuSection section(TransportSlot());
     uint8_t note = note_pool[key]; // Retrieve the note from the note pool using the key
     if (!midiBle)
     {
@@ -227,6 +259,8 @@ void MidiProvider::SendAfterTouch(uint8_t key, uint8_t pressure, uint8_t channel
 
 void MidiProvider::SendPitchBend(int bend, uint8_t channel)
 {
+    lastChannelMessage = micros();
+    CpuSection section(TransportSlot());
     if (!midiBle)
     {
         MIDI_USB.sendPitchBend(bend, channel);
@@ -243,6 +277,8 @@ void MidiProvider::SendPitchBend(int bend, uint8_t channel)
 
 void MidiProvider::SendControlChange(uint8_t controller, uint8_t value, uint8_t channel)
 {
+    lastChannelMessage = micros();
+    CpuSection section(TransportSlot());
     if (!midiBle)
     {
         MIDI_USB.sendControlChange(controller, value, channel);
@@ -259,13 +295,45 @@ void MidiProvider::SendControlChange(uint8_t controller, uint8_t value, uint8_t
 
 void MidiProvider::SendSysEx(size_t size, const byte *data)
 {
-    MIDI_USB.sendSysEx(size, data);
+    {
+        CpuSection section(CpuMonitor::USB);
+        MIDI_USB.sendSysEx(size, data);
+    }
     if (midiBle)
     {
+        CpuSection section(CpuMonitor::BLE);
         MIDI_BLE.sendSysEx(size, data);
     }
 }
 
+bool MidiProvider::QueueSysEx(size_t size, const byte *data)
+{
+    if (queuedSize > 0 || size == 0 || size > QUEUED_SYSEX_SIZE)
+    {
+        return false;
+    }
+    memcpy(queuedSysEx, data, size);
+    queuedSize = size;
+    queuedTime = micros();
+    return true;
+}
+
+void MidiProvider::FlushQueuedSysEx()
+{
+    if (queuedSize == 0)
+    {
+        return;
+    }
+    ulong now = micros();
+    if (now - lastChannelMessage < QUEUED_SYSEX_QUIET && now - queuedTime < QUEUED_SYSEX_MAX_WAIT)
+    {
+        return;
+    }
+    CpuSection section(CpuMonitor::USB);
+    MIDI_USB.sendSysEx(queuedSize, queuedSysEx);
+    queuedSize = 0;
+}
+
 void MidiProvider::SetHandleSystemExclusive(void (*function)(byte *, unsigned))
 {
     MIDI_USB.setHandleSystemExclusive(function);
@@ -316,9 +384,11 @@ void MidiProvider::SetMidiTRSType(bool type)
 
 void MidiProvider::ClearChordPool(uint8_t channel)
 {
-    SendChordOff(chord_pool[0], channel);
-    for (int i = 0; i < 5; i++)
+    for (uint8_t key = 0; key < 16; key++)
     {
-        chord_pool[i] = -1;
+        if (chord_pool[key][0] != -1)
+        {
+            SendChordOff(key, channel);
+        }
     }
 }
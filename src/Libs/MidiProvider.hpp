@@ -7,6 +7,8 @@
 #include <Adafruit_TinyUSB.h>
 #include <BLEMIDI_Transport.h>
 #include <hardware/BLEMIDI_ESP32_NimBLE.h>
+#include "CpuMonitor.hpp"
+#include "LatencyTrace.hpp"
 struct CustomSettings : public midi::DefaultSettings
 {
     static const bool Use1ByteParsing = false;
@@ -24,7 +26,8 @@ public:
     void SendNoteOn(uint8_t key, uint8_t note, uint8_t velocity, uint8_t channel);
     void SendNoteOff(uint8_t key, uint8_t channel);
     void SendAfterTouch(uint8_t key, uint8_t pressure, uint8_t channel);
-    void SendChordOn(uint8_t key, uint8_t note, int8_t (*chord)[4], uint8_t velocity, uint8_t channel);
+    // chord notes are relative to the root note, all of them go out as one batch per transport
+    void SendChordOn(uint8_t key, uint8_t root, const int8_t *chord, uint8_t size, uint8_t velocity, uint8_t channel);
     void SendChordOff(uint8_t key, uint8_t channel);
     void SendChordPressure(uint8_t key, uint8_t pressure, uint8_t channel);
 
@@ -34,6 +37,11 @@ public:
     void SendPitchBend(int bend, uint8_t channel);
     void SendControlChange(uint8_t controller, uint8_t value, uint8_t channel);
     void SendSysEx(size_t size, const byte *data);
+    // Lowest priority SysEx, USB only. One message waits in a slot and goes out from FlushQueuedSysEx
+    // once no channel message has been sent for a while. Returns false while the slot is taken.
+    bool QueueSysEx(size_t size, const byte *data);
+    bool IsSysExQueued() { return queuedSize > 0; };
+    void FlushQueuedSysEx();
     void SetHandleSystemExclusive(void (*function)(byte *, unsigned));
     void SetMidiThru(bool enabled);
     void SetMidiOut(bool enabled);
@@ -41,6 +49,11 @@ public:
 
     void ClearChordPool(uint8_t channel);
 
+    static const uint8_t MAX_CHORD_NOTES = 4;
+    static const size_t QUEUED_SYSEX_SIZE = 128;
+    static const ulong QUEUED_SYSEX_QUIET = 5000;     // us without channel messages before a queued SysEx goes out
+    static const ulong QUEUED_SYSEX_MAX_WAIT = 250000; // us, sent anyway after this long
+
     void SetMidiTRSType(bool type);
 
 private:
@@ -57,11 +70,20 @@ private:
     bool midiOut;
     bool midiTRSType;
 
+    // CPU time of a message goes to the transport it is sent on
+    CpuMonitor::Slot TransportSlot() { return midiBle ? CpuMonitor::BLE : CpuMonitor::USB; };
+    void SendChordMessage(midi::MidiType type, const int8_t *notes, uint8_t data, uint8_t channel);
+
     int8_t note_pool[16];
-    int8_t chord_pool[5]; // 1 for the key, 4 for the notes
+    int8_t chord_pool[16][MAX_CHORD_NOTES]; // notes of the chord held by each key
     int8_t strum_pool[7];
 
     int8_t pin_rx, pin_tx, pin_tx2;
+
+    byte queuedSysEx[QUEUED_SYSEX_SIZE];
+    size_t queuedSize = 0;
+    ulong queuedTime = 0;
+    ulong lastChannelMessage = 0;
 };
 
 #endif// MIDIPROVIDER_HPP
@@ -0,0 +1,68 @@
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+#include <stddef.h>
+#include <atomic>
+
+// Lock-free queue for exactly one producer and one consumer, which can run on different cores.
+// Size must be a power of two.
+template <typename T, size_t Size>
+class RingBuffer
+{
+    static_assert(Size > 0 && (Size & (Size - 1)) == 0, "RingBuffer size must be a power of two");
+
+public:
+    // Producer side, returns false when the queue is full
+    bool Push(const T &item)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == Size)
+        {
+            return false;
+        }
+        _buffer[head & (Size - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, returns false when the queue is empty
+    bool Pop(T &item)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = _buffer[tail & (Size - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, reads the oldest item without removing it
+    bool Peek(T &item) const
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = _buffer[tail & (Size - 1)];
+        return true;
+    }
+
+    bool IsEmpty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+    size_t Count() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    T _buffer[Size];
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+};
+
+#endif // RINGBUFFER_HPP
@@ -0,0 +1,259 @@
+#ifndef SLIDERESTIMATOR_HPP
+#define SLIDERESTIMATOR_HPP
+#include <stdint.h>
+
+// Fixed point position estimator for a linear capacitive slider with Pads pads.
+// Positions are Q16: 0 is the center of the first pad, 65535 the center of the last one.
+template <uint8_t Pads>
+class SliderEstimator
+{
+public:
+    static const uint8_t MAX_TOUCHES = 2;
+
+    struct Touch
+    {
+        uint16_t position;
+        int32_t strength;
+    };
+
+    SliderEstimator()
+    {
+        for (uint8_t i = 0; i < Pads; i++)
+        {
+            gains[i] = 256;
+            peaks[i] = 0;
+        }
+    }
+
+    // Finds up to MAX_TOUCHES separate fingers, strongest first. Returns the number of touches.
+    uint8_t Estimate(const int *values, int32_t threshold, Touch *touches)
+    {
+        int32_t scaled[Pads];
+        for (uint8_t i = 0; i < Pads; i++)
+        {
+            scaled[i] = (values[i] * gains[i]) >> 8;
+        }
+
+        // Local maxima over the threshold, ties go to the lower pad
+        int8_t first = -1, second = -1;
+        for (uint8_t i = 0; i < Pads; i++)
+        {
+            if (scaled[i] < threshold)
+                continue;
+            if (i > 0 && scaled[i] <= scaled[i - 1])
+                continue;
+            if (i < Pads - 1 && scaled[i] < scaled[i + 1])
+                continue;
+
+            if (first == -1 || scaled[i] > scaled[first])
+            {
+                second = first;
+                first = i;
+            }
+            else if (second == -1 || scaled[i] > scaled[second])
+            {
+                second = i;
+            }
+        }
+
+        if (first == -1)
+        {
+            return 0;
+        }
+
+        uint8_t count = 1;
+        if (second != -1 && IsSeparate(scaled, first, second))
+        {
+            count = 2;
+        }
+
+        if (count == 2)
+        {
+            // each finger is fitted on its own side of the valley, away from the tail of the other one
+            uint8_t low = first < second ? first : second;
+            uint8_t high = first < second ? second : first;
+            uint8_t valley = low + 1;
+            for (uint8_t i = low + 1; i < high; i++)
+            {
+                if (scaled[i] < scaled[valley])
+                    valley = i;
+            }
+            touches[0] = {Interpolate(scaled, first, first == low ? 0 : valley + 1, first == low ? valley - 1 : Pads - 1), scaled[first]};
+            touches[1] = {Interpolate(scaled, second, second == low ? 0 : valley + 1, second == low ? valley - 1 : Pads - 1), scaled[second]};
+        }
+        else
+        {
+            touches[0] = {Interpolate(scaled, first, 0, Pads - 1), scaled[first]};
+            if (learnGains)
+            {
+                LearnGain(values, scaled, first);
+            }
+        }
+        return count;
+    }
+
+    // Gains are Q8, 256 being unity
+    void SetGain(uint8_t pad, uint16_t gain) { gains[pad] = gain; };
+    uint16_t GetGain(uint8_t pad) const { return gains[pad]; };
+    void SetGainLearning(bool enabled) { learnGains = enabled; };
+
+private:
+    static const int32_t VALLEY_RATIO = 60; // % of the weaker peak the valley must stay under
+    static const int32_t CENTERED = 48;     // max Q8 offset from a pad center to learn its gain
+    static const int32_t WEAK_RATIO = 16;   // pads under 1/16 of the peak are mostly noise in the log domain
+    static const int32_t CURVATURE = 1026;  // log2 Q8 second difference of a finger 0.6 pads wide
+
+    uint16_t gains[Pads];
+    int32_t peaks[Pads]; // average raw peak of a finger centered on each pad
+    int32_t curvature = CURVATURE; // learned with the gains, sets the finger width of two pad fits
+    bool learnGains = true;
+
+    // Two peaks are two fingers only if there is a clear valley between them
+    bool IsSeparate(const int32_t *scaled, uint8_t a, uint8_t b) const
+    {
+        uint8_t low = a < b ? a : b;
+        uint8_t high = a < b ? b : a;
+        if (high - low < 2)
+        {
+            return false;
+        }
+        int32_t valley = scaled[low + 1];
+        for (uint8_t i = low + 1; i < high; i++)
+        {
+            if (scaled[i] < valley)
+                valley = scaled[i];
+        }
+        int32_t weaker = scaled[a] < scaled[b] ? scaled[a] : scaled[b];
+        return valley * 100 < weaker * VALLEY_RATIO;
+    }
+
+    // log2 in Q8, v must be > 0
+    static int32_t Log2(uint32_t v)
+    {
+        static const uint16_t lut[17] = {0, 22, 44, 63, 82, 100, 118, 134, 150, 165, 179, 193, 207, 220, 232, 244, 256};
+        int32_t exponent = 31 - __builtin_clz(v);
+        uint32_t mantissa = v << (31 - exponent); // leading one in bit 31
+        uint8_t idx = (mantissa >> 27) & 0x0F;
+        uint8_t frac = (mantissa >> 19) & 0xFF;
+        return (exponent << 8) + lut[idx] + (((lut[idx + 1] - lut[idx]) * frac) >> 8);
+    }
+
+    // Q8 offset of the vertex of the parabola through (-1, l), (0, c), (1, r)
+    static int32_t Vertex(int32_t l, int32_t c, int32_t r)
+    {
+        int32_t den = 2 * (2 * c - l - r);
+        if (den <= 0)
+        {
+            return 0;
+        }
+        int32_t offset = ((r - l) << 8) / den;
+        if (offset > 256)
+            offset = 256;
+        if (offset < -256)
+            offset = -256;
+        return offset;
+    }
+
+    // Q8 position of the finger in pad units, around the given peak pad. Only the pads from low to high
+    // belong to this finger.
+    int32_t PeakPosition(const int32_t *scaled, uint8_t peak, uint8_t low, uint8_t high) const
+    {
+        // three pads around the peak, shifted inwards at the ends of the slider
+        uint8_t center = peak == 0 ? 1 : (peak == Pads - 1 ? Pads - 2 : peak);
+        if (center - 1 >= low && center + 1 <= high)
+        {
+            int32_t l = scaled[center - 1];
+            int32_t c = scaled[center];
+            int32_t r = scaled[center + 1];
+
+            int32_t floor = scaled[peak] / WEAK_RATIO;
+            if (l > floor && c > floor && r > floor)
+            {
+                // A finger gives a roughly gaussian profile, which is a parabola in the log domain
+                int32_t ll = Log2(l), lc = Log2(c), lr = Log2(r);
+                if (2 * lc - ll - lr > 0)
+                {
+                    return ((int32_t)center << 8) + Vertex(ll, lc, lr);
+                }
+            }
+            else if (peak != 0 && peak != Pads - 1 && (l <= 0 || r <= 0))
+            {
+                return ((int32_t)peak << 8) + Vertex(l, c, r);
+            }
+        }
+
+        // Only one usable neighbour, the stronger one
+        int8_t neighbour = -1;
+        if (peak > low && (peak == high || scaled[peak - 1] >= scaled[peak + 1]))
+            neighbour = peak - 1;
+        else if (peak < high)
+            neighbour = peak + 1;
+        if (neighbour == -1 || scaled[neighbour] <= 0 || scaled[peak] <= 0)
+        {
+            return (int32_t)peak << 8;
+        }
+        // gaussian of the learned width through both pads, halfway between them when they are equal
+        int32_t offset = 128 + ((Log2(scaled[neighbour]) - Log2(scaled[peak])) << 8) / curvature;
+        if (offset < -256)
+            offset = -256;
+        if (offset > 128)
+            offset = 128;
+        return ((int32_t)peak << 8) + (neighbour > peak ? offset : -offset);
+    }
+
+    uint16_t Interpolate(const int32_t *scaled, uint8_t peak, uint8_t low, uint8_t high) const
+    {
+        int32_t position = PeakPosition(scaled, peak, low, high);
+        if (position < 0)
+            position = 0;
+        const int32_t range = (Pads - 1) << 8;
+        if (position > range)
+            position = range;
+        return (uint16_t)((position * 65535) / range);
+    }
+
+    // Equalises the pads from the peaks of single, centered touches
+    void LearnGain(const int *values, const int32_t *scaled, uint8_t peak)
+    {
+        int32_t offset = PeakPosition(scaled, peak, 0, Pads - 1) - ((int32_t)peak << 8);
+        if (offset > CENTERED || offset < -CENTERED)
+        {
+            return;
+        }
+        if (peak > 0 && peak < Pads - 1 && scaled[peak - 1] > 0 && scaled[peak + 1] > 0)
+        {
+            int32_t second = 2 * Log2(scaled[peak]) - Log2(scaled[peak - 1]) - Log2(scaled[peak + 1]);
+            curvature += (second - curvature) >> 4;
+            if (curvature < 256)
+                curvature = 256;
+            if (curvature > 4096)
+                curvature = 4096;
+        }
+        if (peaks[peak] == 0)
+            peaks[peak] = values[peak];
+        else
+            peaks[peak] += (values[peak] - peaks[peak]) >> 4;
+
+        int32_t sum = 0;
+        uint8_t learned = 0;
+        for (uint8_t i = 0; i < Pads; i++)
+        {
+            if (peaks[i] > 0)
+            {
+                sum += peaks[i];
+                learned++;
+            }
+        }
+        int32_t mean = sum / learned;
+        for (uint8_t i = 0; i < Pads; i++)
+        {
+            if (peaks[i] > 0)
+            {
+                int32_t gain = (mean << 8) / peaks[i];
+                gains[i] = gain < 128 ? 128 : (gain > 512 ? 512 : gain);
+            }
+        }
+    }
+};
+
+#endif // SLIDERESTIMATOR_HPP
@@ -0,0 +1,140 @@
+#ifndef SLIDERGESTURES_HPP
+#define SLIDERGESTURES_HPP
+#include <stdint.h>
+#include <math.h>
+
+enum class Gesture : uint8_t
+{
+    TAP,
+    DOUBLE_TAP,
+    FLICK,
+    HOLD,
+};
+
+struct GestureEvent
+{
+    Gesture type;
+    int8_t direction; // flick direction, 1 towards the end of the slider
+    float position;   // where the gesture started
+};
+
+// Turns the touch/position stream of the slider into gestures and momentum.
+// Meant to be called at a fixed rate, every call costs the same whether something happens or not.
+class GestureRecognizer
+{
+public:
+    // Returns true when a gesture has been recognized, described by event
+    bool Update(bool touched, float position, unsigned long now, GestureEvent &event)
+    {
+        bool recognized = false;
+        unsigned long dt = now - lastTime;
+        lastTime = now;
+
+        if (touched && !wasTouched)
+        {
+            // touch down, stops any momentum
+            downTime = now;
+            downPosition = position;
+            lastPosition = position;
+            velocity = 0.0f;
+            travel = 0.0f;
+            holdSent = false;
+            coasting = false;
+        }
+        else if (touched)
+        {
+            if (dt > 0)
+            {
+                float delta = position - lastPosition;
+                travel += fabsf(delta);
+                // slider lengths per second, lightly smoothed
+                velocity = velocity * 0.6f + (delta * 1000.0f / dt) * 0.4f;
+            }
+            lastPosition = position;
+
+            if (!holdSent && travel < TAP_DISTANCE && now - downTime > HOLD_TIME)
+            {
+                holdSent = true;
+                event = {Gesture::HOLD, 0, downPosition};
+                recognized = true;
+            }
+        }
+        else if (wasTouched)
+        {
+            // touch up
+            unsigned long duration = now - downTime;
+            if (!holdSent && duration < TAP_TIME && travel < TAP_DISTANCE)
+            {
+                bool isDouble = (downTime - lastTapTime < DOUBLE_TAP_TIME) && fabsf(downPosition - lastTapPosition) < DOUBLE_TAP_DISTANCE;
+                event = {isDouble ? Gesture::DOUBLE_TAP : Gesture::TAP, 0, downPosition};
+                recognized = true;
+                // a double tap does not start another one
+                lastTapTime = isDouble ? 0 : now;
+                lastTapPosition = downPosition;
+            }
+            else if (duration < FLICK_TIME && fabsf(velocity) > FLICK_SPEED)
+            {
+                event = {Gesture::FLICK, (int8_t)(velocity > 0.0f ? 1 : -1), downPosition};
+                recognized = true;
+                coasting = true;
+            }
+        }
+        else if (coasting && dt > 0)
+        {
+            // exponential friction, time constant MOMENTUM_DECAY
+            velocity -= velocity * (float)dt / MOMENTUM_DECAY;
+            if (fabsf(velocity) < MOMENTUM_STOP)
+            {
+                coasting = false;
+                velocity = 0.0f;
+            }
+        }
+
+        wasTouched = touched;
+        return recognized;
+    }
+
+    bool IsCoasting() const { return coasting; };
+    void Stop() { coasting = false; };
+
+    // Moves position along the momentum, for the dt of the last Update. Stops at the ends.
+    float Coast(float position, unsigned long dt)
+    {
+        if (!coasting)
+        {
+            return position;
+        }
+        position += velocity * (float)dt / 1000.0f;
+        if (position <= 0.0f || position >= 1.0f)
+        {
+            coasting = false;
+            position = position < 0.0f ? 0.0f : (position > 1.0f ? 1.0f : position);
+        }
+        return position;
+    }
+
+private:
+    static constexpr unsigned long TAP_TIME = 200;        // ms
+    static constexpr unsigned long DOUBLE_TAP_TIME = 350; // ms between the end of a tap and the next touch
+    static constexpr unsigned long HOLD_TIME = 600;       // ms
+    static constexpr unsigned long FLICK_TIME = 350;      // ms, longer swipes are just drags
+    static constexpr float TAP_DISTANCE = 0.06f;          // slider lengths
+    static constexpr float DOUBLE_TAP_DISTANCE = 0.2f;    // slider lengths
+    static constexpr float FLICK_SPEED = 1.5f;            // slider lengths per second
+    static constexpr float MOMENTUM_DECAY = 250.0f;       // ms
+    static constexpr float MOMENTUM_STOP = 0.05f;         // slider lengths per second
+
+    bool wasTouched = false;
+    bool holdSent = false;
+    bool coasting = false;
+    unsigned long lastTime = 0;
+    unsigned long downTime = 0;
+    unsigned long lastTapTime = 0;
+    float downPosition = 0.0f;
+    float lastPosition = 0.0f;
+    float lastTapPosition = 0.0f;
+    float travel = 0.0f;
+    float velocity = 0.0f;
+};
+
+#endif // SLIDERGESTURES_HPP
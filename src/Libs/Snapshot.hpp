@@ -0,0 +1,42 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+#include <stdint.h>
+#include <atomic>
+
+// Sequence lock: one writer publishes a whole struct, any number of readers get a consistent copy
+// without ever blocking the writer. T must be trivially copyable.
+template <typename T>
+class Snapshot
+{
+public:
+    void Publish(const T &value)
+    {
+        uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(sequence + 1, std::memory_order_relaxed); // odd while writing
+        std::atomic_thread_fence(std::memory_order_release);
+        _data = value;
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    T Read() const
+    {
+        T value;
+        uint32_t before, after;
+        do
+        {
+            before = _sequence.load(std::memory_order_acquire);
+            value = _data;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = _sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return value;
+    }
+
+    uint32_t GetSequence() const { return _sequence.load(std::memory_order_acquire); }
+
+private:
+    T _data = {};
+    std::atomic<uint32_t> _sequence{0};
+};
+
+#endif // SNAPSHOT_HPP
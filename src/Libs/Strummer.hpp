@@ -0,0 +1,117 @@
+#ifndef STRUMMER_HPP
+#define STRUMMER_HPP
+#include <stdint.h>
+#include "RingBuffer.hpp"
+#include "Signal.hpp"
+
+#define STRUM_QUEUE 16
+
+// Turns timestamped slider pad crossings into strummed strings.
+// Velocity follows the swipe speed, and the strings keep the spacing they were
+// crossed with even when the crossings reach the main loop in a burst.
+class Strummer
+{
+public:
+    // time is the micros() at the end of the touch scan that saw the crossing, now the micros() of the dispatch.
+    // fallbackVelocity is used for the first string of a strum, when there is no speed yet.
+    void Cross(uint8_t string, bool state, unsigned long time, unsigned long now, uint8_t fallbackVelocity)
+    {
+        bool newStrum = time - lastCrossing > STRUM_GAP;
+        unsigned long latency = now - time;
+        // A new strum starts from the current latency, within a strum the latency can only grow,
+        // otherwise the strings would get squeezed together
+        if (newStrum || latency > offset)
+        {
+            offset = latency;
+        }
+
+        StrumNote note = {string, state, 0, time + offset};
+        if (state)
+        {
+            note.velocity = Velocity(string, time, fallbackVelocity, newStrum);
+            lastString = string;
+        }
+        lastCrossing = time;
+
+        if (!pending.Push(note))
+        {
+            // Queue full, nothing to keep the spacing for anymore
+            Flush();
+            onString.Emit(note.string, note.state, note.velocity);
+        }
+    }
+
+    // Plays the strings that are due
+    void Update(unsigned long now)
+    {
+        StrumNote note;
+        while (pending.Peek(note) && (long)(now - note.time) >= 0)
+        {
+            pending.Pop(note);
+            onString.Emit(note.string, note.state, note.velocity);
+        }
+    }
+
+    void Flush()
+    {
+        StrumNote note;
+        while (pending.Pop(note))
+        {
+            onString.Emit(note.string, note.state, note.velocity);
+        }
+    }
+
+    uint8_t GetVelocity() { return velocity; };
+
+    Signal<uint8_t, bool, uint8_t> onString;
+
+private:
+    static const unsigned long STRUM_GAP = 120000; // us without crossings that ends a strum
+    static const uint32_t SLOW_SPEED = 10;         // strings per second for the softest strum
+    static const uint32_t FAST_SPEED = 150;        // strings per second for the hardest strum
+    static const uint8_t MIN_VELOCITY = 30;
+
+    struct StrumNote
+    {
+        uint8_t string;
+        bool state;
+        uint8_t velocity;
+        unsigned long time; // micros() at which it has to be played
+    };
+
+    RingBuffer<StrumNote, STRUM_QUEUE> pending;
+    unsigned long lastCrossing = 0;
+    unsigned long lastOnset = 0;
+    unsigned long offset = 0;
+    uint8_t lastString = 0;
+    uint8_t velocity = 100;
+
+    uint8_t Velocity(uint8_t string, unsigned long time, uint8_t fallback, bool newStrum)
+    {
+        unsigned long interval = time - lastOnset;
+        lastOnset = time;
+        bool adjacent = string + 1 == lastString || lastString + 1 == string;
+
+        if (newStrum || !adjacent || interval == 0)
+        {
+            if (fallback > 0)
+            {
+                velocity = fallback;
+            }
+            return velocity;
+        }
+
+        uint32_t speed = 1000000UL / interval;
+        if (speed < SLOW_SPEED)
+            speed = SLOW_SPEED;
+        if (speed > FAST_SPEED)
+            speed = FAST_SPEED;
+        uint8_t target = MIN_VELOCITY + ((speed - SLOW_SPEED) * (127 - MIN_VELOCITY)) / (FAST_SPEED - SLOW_SPEED);
+
+        // Smoothed over consecutive strings, one uneven crossing should not stand out
+        velocity = (velocity + target + 1) / 2;
+        return velocity;
+    }
+};
+
+#endif // STRUMMER_HPP
@@ -0,0 +1,14 @@
+#ifndef SYSEXPACK_HPP
+#define SYSEXPACK_HPP
+
+#include <stdint.h>
+
+// Writes value into message at size as bytes 7 bit groups, most significant first. Returns the new size.
+inline uint16_t PackSysEx7(uint8_t *message, uint16_t size, uint32_t value, uint8_t bytes)
+{
+    for (int8_t i = bytes - 1; i >= 0; i--)
+        message[size++] = (value >> (i * 7)) & 0x7F;
+    return size;
+}
+
+#endif // SYSEXPACK_HPP
@@ -3,14 +3,33 @@
 void CapTouch::Init(uint8_t pin)
 {
     _pin = pin;
-    pinMode(_pin, INPUT);
+    _channel = (touch_pad_t)digitalPinToTouchChannel(_pin);
+    touch_pad_config(_channel);
+}
+
+uint32_t CapTouch::ReadRaw()
+{
+    // Returns the value latched by the last FSM scan, never waits for a measurement
+    uint32_t value = 0;
+    touch_pad_read_raw_data(_channel, &value);
+    return value;
+}
+
+void CapTouch::Calibrate()
+{
     // Intialize history and smoothed value to an average of a few readings
+    float sum = 0.0;
     for (int i = 0; i < 10; i++)
     {
-        raw += touchRead(_pin);
+        sum += ReadRaw();
         delay(3);
     }
-    raw = raw / 10;
+    Calibrate(sum / 10);
+}
+
+void CapTouch::Calibrate(float raw)
+{
+    this->raw = raw;
     p3 = raw;
     p2 = raw;
     p1 = raw;
@@ -18,9 +37,14 @@ void CapTouch::Init(uint8_t pin)
     baseline = raw;
 }
 
-int CapTouch::GetValue()
+int CapTouch::Update()
+{
+    return Update(ReadRaw());
+}
+
+int CapTouch::Update(uint32_t raw)
 {
-    raw = touchRead(_pin);
+    this->raw = raw;
 
     p1 = raw; // Latest point in the history
 
@@ -55,13 +79,40 @@ int CapTouch::GetValue()
 }
 ////////////////////////////////////////////
 
+volatile uint32_t TouchSlider::scanCount = 0;
+volatile ulong TouchSlider::scanTime = 0;
+
+void IRAM_ATTR TouchSlider::OnScanDone(void *arg)
+{
+    // the time first, a reader that sees the new count also sees its time
+    scanTime = micros();
+    scanCount++;
+}
+
 void TouchSlider::Init(uint8_t *gpio)
 {
+    touch_pad_init();
+    touch_pad_set_meas_time(TOUCH_SLEEP_CYCLES, TOUCH_MEASURE_CYCLES);
+    touch_pad_set_voltage(TOUCH_HVOLT_2V7, TOUCH_LVOLT_0V5, TOUCH_HVOLT_ATTEN_0V5);
+    touch_pad_set_idle_channel_connect(TOUCH_PAD_IDLE_CH_CONNECT_DEFAULT);
 
     for (uint8_t i = 0; i < NUM_SENSORS; i++)
     {
         t[i].Init(gpio[i]);
     }
+
+    // Let the hardware timer run the scans, results are picked up without blocking
+    touch_pad_set_fsm_mode(TOUCH_FSM_MODE_TIMER);
+    touch_pad_isr_register(OnScanDone, this, TOUCH_PAD_INTR_MASK_SCAN_DONE);
+    touch_pad_intr_enable(TOUCH_PAD_INTR_MASK_SCAN_DONE);
+    touch_pad_fsm_start();
+
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        t[i].Calibrate();
+    }
+    lastScan = scanCount;
+    Publish();
     timer.Restart();
 
     log_d("TouchSlider initialized");
@@ -74,7 +125,7 @@ uint8_t TouchSlider::GetQuantizedPosition(uint8_t numPositions)
         return 0; // Guard against division by zero if no positions are specified
 
     float interval = 1.0f / numPositions;
-    uint8_t quantized_position = static_cast<uint8_t>(lastPosition / interval);
+    uint8_t quantized_position = static_cast<uint8_t>(GetPosition() / interval);
 
     // Ensure that the maximum index does not exceed numPositions - 1
     if (quantized_position >= numPositions)
@@ -93,59 +144,44 @@ void TouchSlider::SetPosition(uint8_t intPosition, uint8_t numPositions)
 
 bool TouchSlider::ReadValues()
 {
-    // Read values from sensors
+    // Filter the latest scan, once per sensor
+    uint32_t raw[NUM_SENSORS];
     for (int i = 0; i < NUM_SENSORS; i++)
     {
-        sensorValues[i] = ReadSensorValue(i);
+        raw[i] = t[i].ReadRaw();
     }
+    return ReadValues(raw);
+}
 
-    // Find the sensor with the highest value
-    int maxValue = 0;
-    int maxSensor = 0;
+bool TouchSlider::ReadValues(const uint32_t *raw)
+{
     for (int i = 0; i < NUM_SENSORS; i++)
     {
-        if (sensorValues[i] > maxValue)
-        {
-            maxValue = sensorValues[i];
-            maxSensor = i;
-        }
+        sensorValues[i] = t[i].Update(raw[i]);
     }
 
-    if (maxValue >= touchThreshold)
+    SliderEstimator<NUM_SENSORS>::Touch found[SliderEstimator<NUM_SENSORS>::MAX_TOUCHES];
+    touchCount = estimator.Estimate(sensorValues, touchThreshold, found);
+
+    if (touchCount > 0)
     {
         timer.CalculateDeltaTime();
-        int32_t deltaTime = timer.GetDeltaTime();
-        // Approximate position using linear interpolation
-        int nextSensor = maxSensor == NUM_SENSORS - 1 ? maxSensor : maxSensor + 1;
-        int prevSensor = maxSensor == 0 ? maxSensor : maxSensor - 1;
-
-        float sum = sensorValues[maxSensor] + sensorValues[prevSensor] + sensorValues[nextSensor];
-
-        // Proportions
-        float c1 = maxSensor == 0 ? 0 : sensorValues[prevSensor] / sum;
-        float c2 = sensorValues[maxSensor] / sum;
-        float c3 = maxSensor == NUM_SENSORS - 1 ? 0 : sensorValues[nextSensor] / sum;
+        int32_t deltaTime = max((int32_t)timer.GetDeltaTime(), (int32_t)1);
 
-        // Offset
-        float offset = 0.0f;
-        if (c1 > c3)
+        // With two fingers keep following the one closest to where we were
+        uint8_t primary = 0;
+        if (touchCount > 1 && touched)
         {
-            offset = -c1;
+            float d0 = fabsf(found[0].position / 65535.0f - lastPosition);
+            float d1 = fabsf(found[1].position / 65535.0f - lastPosition);
+            primary = d1 < d0 ? 1 : 0;
         }
-        else
-        {
-            offset = c3;
-        }
-
-        float offsetPad = static_cast<float>(maxSensor) + offset; // Offset relative to pad
-        float position = offsetPad / (NUM_SENSORS - 1);           // Adjusted for slider (0 to 1)
-
-        position = constrain(position * 1.04f - 0.02f, 0.0f, 1.0f);
+        float position = found[primary].position / 65535.0f;
+        secondPosition = touchCount > 1 ? found[1 - primary].position / 65535.0f : position;
 
         if (!touched)
         {
             touched = true;
-            startPosition = position;
             lastPosition = position;
         }
 
@@ -182,4 +218,19 @@ bool TouchSlider::ReadValues()
     }
 
     return touched;
-}
\ No newline at end of file
+}
+
+void TouchSlider::UpdateStats(ulong elapsed)
+{
+    statsUpdates++;
+    statsTime += elapsed;
+    ulong now = millis();
+    if (now - statsStart >= 1000)
+    {
+        updateRate = (float)statsUpdates / (now - statsStart) * 1000.0f;
+        updateTime = (float)statsTime / statsUpdates;
+        statsStart = now;
+        statsUpdates = 0;
+        statsTime = 0;
+    }
+}
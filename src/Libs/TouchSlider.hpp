@@ -1,11 +1,21 @@
 #ifndef TOUCHSLIDER_HPP
 #define TOUCHSLIDER_HPP
 #include <Arduino.h>
+#include <driver/touch_sensor.h>
 #include "Timer.hpp"
 #include "Signal.hpp"
+#include "RingBuffer.hpp"
+#include "Snapshot.hpp"
+#include "SliderEstimator.hpp"
+#include "SliderGestures.hpp"
+#include "CpuMonitor.hpp"
 
 #define NUM_SENSORS 7
 
+// The touch FSM scans all the slider pads in the background, every scan latches a new raw value per pad
+#define TOUCH_SLEEP_CYCLES 0x100   // idle time between two scans, in RTC slow clock cycles
+#define TOUCH_MEASURE_CYCLES 0x1000 // charge/discharge cycles per pad, the thresholds are tuned for this
+
 class CapTouch
 {
 public:
@@ -13,13 +23,19 @@ public:
     CapTouch(uint8_t pin) { _pin = pin; };
 
     void Init(uint8_t pin);
-    int GetValue();
+    void Calibrate();
+    void Calibrate(float raw); // starts the history and the baseline at a given measurement
+    int Update();              // filters the last latched measurement, call once per scan
+    int Update(uint32_t raw);  // filters a given measurement
+    uint32_t ReadRaw();        // measurement latched by the last FSM scan
+    int GetValue() { return _lastValue; };
     bool IsPressed() { return _pressed; };
     void SetThreshold(uint16_t threshold) { _threshold = threshold; };
 
 private:
     // HW
     uint8_t _pin = 0;
+    touch_pad_t _channel = TOUCH_PAD_MAX;
 
     // SMOOTHING
     float p1 = 0.0, p2 = 0.0, p3 = 0.0; // 3-Point history
@@ -39,6 +55,31 @@ private:
     int _lastValue = 0;
 };
 
+#define SLIDER_TASK_PERIOD_MS 2 // slider task rate, faster than the touch FSM scans
+#define SLIDER_EVENT_QUEUE 32    // pad edges buffered between the slider task and loop()
+#define SLIDER_GESTURE_QUEUE 8   // gestures buffered between the slider task and loop()
+
+// State published by the slider task, read as a whole from any task
+struct SliderState
+{
+    float position = 0.0f;
+    float speed = 0.0f; // signed, positive towards the end of the slider
+    float distance = 0.0f;
+    bool touched = false;
+    uint8_t touches = 0;         // separate fingers on the slider, up to 2
+    float secondPosition = 0.0f; // position of the other finger, same as position with one touch
+    bool coasting = false;       // position is still moving from the momentum of a flick
+    uint8_t pads = 0;            // bitmask of the pads over the touch threshold
+    ulong time = 0;              // millis() of the scan
+};
+
+struct SliderEvent
+{
+    uint8_t pad;
+    bool state;
+    ulong time; // micros() of the end of the scan that detected the edge
+};
+
 class TouchSlider
 {
 public:
@@ -46,39 +87,137 @@ public:
 
     CapTouch t[NUM_SENSORS]; // Change this to match your slider
     void Init(uint8_t *gpio);
-    void SetPosition(float position) { lastPosition = position; };
+    void SetPosition(float position)
+    {
+        // applied by the slider task on its next run, reported back right away
+        requestedPosition.store(position, std::memory_order_relaxed);
+        positionRequests.fetch_add(1, std::memory_order_release);
+    };
     void SetPosition(uint8_t intPosition, uint8_t numPositions);
-    float GetPosition() { return lastPosition; };
+    float GetPosition()
+    {
+        if (positionRequests.load(std::memory_order_acquire) != positionApplied.load(std::memory_order_acquire))
+        {
+            return requestedPosition.load(std::memory_order_relaxed);
+        }
+        return state.Read().position;
+    };
     uint8_t GetQuantizedPosition(uint8_t numPositions);
-    float GetSpeed() { return speed * (float)direction; };
+    float GetSpeed() { return state.Read().speed; };
+    uint8_t GetTouchCount() { return state.Read().touches; };
+    float GetSecondPosition() { return state.Read().secondPosition; };
+    SliderEstimator<NUM_SENSORS> &GetEstimator() { return estimator; };
+    SliderState GetState() { return state.Read(); };
     bool ReadValues();
+    bool ReadValues(const uint32_t *raw); // from given measurements, one per pad
 
+    // Runs on the slider task, or from loop() when the task is not started
     void Update()
     {
-        float prevPosition = GetPosition();
-        ReadValues();
-        for (uint8_t i = 0; i < NUM_SENSORS; i++)
+        ulong now = millis();
+        bool changed = false;
+        bool scanned = false;
+        // a request made while this one is applied leaves the count ahead and is applied on the next run
+        uint32_t requests = positionRequests.load(std::memory_order_acquire);
+        if (requests != positionApplied.load(std::memory_order_relaxed))
         {
-            bool currentState = IsTouched(i, 18000);
+            lastPosition = requestedPosition.load(std::memory_order_relaxed);
+            gestures.Stop();
+            Publish();
+            positionApplied.store(requests, std::memory_order_release);
+        }
 
-            if (currentState && !prevSensorState[i])
+        // Only read the pads once the touch FSM has latched a new scan. Edges are stamped with the time the
+        // scan finished, a scan done while reading the pair makes it read again.
+        uint32_t scan;
+        ulong scanEnd;
+        do
+        {
+            scan = scanCount;
+            scanEnd = scanTime;
+        } while (scan != scanCount);
+        ulong start = micros();
+        if (scan != lastScan)
+        {
+            lastScan = scan;
+            ReadValues();
+            for (uint8_t i = 0; i < NUM_SENSORS; i++)
             {
-                onSensorTouched.Emit(i, true);
+                bool currentState = IsTouched(i, 18000);
+
+                if (currentState != prevSensorState[i])
+                {
+                    if (!events.Push({i, currentState, scanEnd}))
+                    {
+                        log_d("Slider event queue full");
+                    }
+                }
+
+                prevSensorState[i] = currentState;
             }
-            else if (!currentState && prevSensorState[i])
+            changed = true;
+            scanned = true;
+        }
+
+        // Gestures and momentum run on every tick
+        GestureEvent gesture;
+        if (gestures.Update(touched, lastPosition, now, gesture))
+        {
+            gestureEvents.Push(gesture);
+        }
+        if (!touched && gestures.IsCoasting())
+        {
+            if (momentum.load(std::memory_order_relaxed))
             {
-                onSensorTouched.Emit(i, false);
+                lastPosition = gestures.Coast(lastPosition, now - lastTick);
+                changed = true;
             }
+            else
+            {
+                gestures.Stop();
+            }
+        }
+        lastTick = now;
+
+        if (changed)
+        {
+            Publish();
+        }
+        // the update rate counts touch scans, not momentum ticks
+        if (scanned)
+        {
+            UpdateStats(micros() - start);
+        }
+    }
 
-            prevSensorState[i] = currentState;
+    // Emits the queued pad edges and gestures on the calling task, call it from loop()
+    void DispatchEvents()
+    {
+        SliderEvent event;
+        while (events.Pop(event))
+        {
+            lastEventTime = event.time;
+            onSensorTouched.Emit(event.pad, event.state);
+        }
+        GestureEvent gesture;
+        while (gestureEvents.Pop(gesture))
+        {
+            onGesture.Emit(gesture.type, gesture.direction);
         }
     }
 
+    // Keep moving the position after a flick, for value selection
+    void SetMomentum(bool enabled) { momentum.store(enabled, std::memory_order_relaxed); };
+
+    // micros() timestamp of the edge currently being dispatched
+    ulong GetEventTime() { return lastEventTime; };
+
     bool IsTouched(float threshold = 0.0f)
     {
+        SliderState current = state.Read();
         if (threshold == 0.0f)
-            return touched;
-        else if (distance > threshold)
+            return current.touched;
+        else if (current.distance > threshold)
         {
             return true;
         }
@@ -86,49 +225,104 @@ public:
             return false;
     };
 
-    int sensorValues[NUM_SENSORS];
-    int direction;
-    float speed;
-
-    bool IsTouched(uint8_t sensorNum, uint16_t threshold = 12000)
+    bool IsPadTouched(uint8_t sensorNum)
     {
-
-        return t[sensorNum].GetValue() > threshold;
+        return state.Read().pads & (1 << sensorNum);
     }
 
+    float GetUpdateRate() { return updateRate; };
+    float GetUpdateTime() { return updateTime; };
+
     Signal<uint8_t, bool> onSensorTouched;
+    Signal<Gesture, int8_t> onGesture;
 
     void Start()
     {
-        xTaskCreatePinnedToCore(TouchSlider::taskUpdate, "TouchSlider", 1024 * 2, this, 1, &_task, 0);
+        xTaskCreatePinnedToCore(TouchSlider::taskUpdate, "TouchSlider", 1024 * 3, this, 2, &_task, 0);
     }
 
     static void taskUpdate(void *pvParameters)
     {
         TouchSlider *slider = static_cast<TouchSlider *>(pvParameters);
+        TickType_t lastWake = xTaskGetTickCount();
         while (1)
         {
-            slider->Update();
-            vTaskDelay(pdMS_TO_TICKS(2));
+            {
+                CpuSection section(CpuMonitor::SLIDER);
+                slider->Update();
+            }
+            vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SLIDER_TASK_PERIOD_MS));
         }
     }
 
 private:
+    // Owned by the slider task
+    int sensorValues[NUM_SENSORS];
+    int direction;
+    float speed;
     int touchThreshold = 12000;
     bool touched = false;
     float distance = 0.0f;
-    float startPosition = 0.0f;
-    float endPosition = 0.0f;
     float lastPosition = 0.0f;
+    float secondPosition = 0.0f;
+    uint8_t touchCount = 0;
+    SliderEstimator<NUM_SENSORS> estimator;
+
+    GestureRecognizer gestures;
+    std::atomic<bool> momentum{false}; // set from the loop, read by the slider task
+    ulong lastTick = 0;
 
-    bool clickDetected = false;
-    unsigned long pressTime = 0;
-    unsigned long releaseTime = 0;
-    const unsigned long clickTime = 300;
     bool prevSensorState[NUM_SENSORS] = {false};
 
+    bool IsTouched(uint8_t sensorNum, uint16_t threshold = 12000)
+    {
+        return sensorValues[sensorNum] > threshold;
+    }
+
+    void Publish()
+    {
+        SliderState current;
+        current.position = lastPosition;
+        current.speed = speed * (float)direction;
+        current.distance = distance;
+        current.touched = touched;
+        current.touches = touchCount;
+        current.coasting = gestures.IsCoasting();
+        current.secondPosition = touchCount > 1 ? secondPosition : lastPosition;
+        for (uint8_t i = 0; i < NUM_SENSORS; i++)
+        {
+            if (prevSensorState[i])
+            {
+                current.pads |= 1 << i;
+            }
+        }
+        current.time = millis();
+        state.Publish(current);
+    }
+
+    // Shared between the slider task and the readers
+    Snapshot<SliderState> state;
+    RingBuffer<SliderEvent, SLIDER_EVENT_QUEUE> events;
+    RingBuffer<GestureEvent, SLIDER_GESTURE_QUEUE> gestureEvents;
+    std::atomic<uint32_t> positionRequests{0}; // SetPosition calls so far
+    std::atomic<uint32_t> positionApplied{0};  // requests published by the slider task
+    std::atomic<float> requestedPosition{0.0f};
+    ulong lastEventTime = 0;
+
     Timer timer;
-    int ReadSensorValue(int sensorNum) { return t[sensorNum].GetValue(); };
+
+    static volatile uint32_t scanCount;
+    static volatile ulong scanTime; // micros() of the last finished scan, written before scanCount
+    static void OnScanDone(void *arg);
+    uint32_t lastScan = 0;
+
+    // slider update rate and average time spent per update, refreshed every second
+    void UpdateStats(ulong elapsed);
+    uint32_t statsUpdates = 0;
+    ulong statsTime = 0;
+    ulong statsStart = 0;
+    float updateRate = 0.0f;
+    float updateTime = 0.0f;
 
     TaskHandle_t _task;
 };
@@ -29,7 +29,12 @@ enum Scale
 };
 
 // Scales are defined as steps from the root note, 0 being the root note and -1 being the end of the scale (used for scales with less than 12 notes)
-int8_t scales[SCALE_AMOUNT][16] = {
+struct ScaleTable
+{
+    int8_t steps[SCALE_AMOUNT][16];
+};
+
+constexpr ScaleTable scale_presets = {{
     {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, -1},       // CHROMATIC
     {0, 2, 4, 5, 7, 9, 11, -1, -1, -1, -1, -1},       // IONIAN
     {0, 2, 3, 5, 7, 9, 10, -1, -1, -1, -1, -1},       // DORIAN
@@ -49,56 +54,25 @@ int8_t scales[SCALE_AMOUNT][16] = {
     {0, 1, 5, 7, 8, -1, -1, -1, -1, -1, -1, -1},      // JAPANESE
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, // CUSTOM1 Placeholder
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}  // CUSTOM2 Placeholder
-};
-
-enum Chord
-{
-    MAJOR = 0,        // Major chord: root, major third, perfect fifth
-    MINOR,            // Minor chord: root, minor third, perfect fifth
-    SUSPENDED_FOURTH, // Suspended fourth chord: root, perfect fourth, perfect fifth
-    DIMINISH,         // Diminished chord: root, minor third, diminished fifth
-    CHORD_AMOUNT
-};
-
-int8_t chords[CHORD_AMOUNT][4] = {
-    {0, 4, 7, -1}, // MAJOR
-    {0, 3, 7, -1}, // MINOR
-    {0, 3, 6, 10}, // SUSPENDED_FOURTH
-    {0, 3, 6, -1}, // DIMINISH
-};
-
-int8_t strum_chords[CHORD_AMOUNT][7] = {
-    {0, 4, 7, 12, 16, 19, 24}, // MAJOR
-    {0, 3, 7, 12, 15, 19, 24}, // MINOR
-    {0, 3, 6, 10, 12, 15, 18}, // SUSPENDED_FOURTH
-    {0, 3, 6, 12, 15, 18, 24}, // DIMINISH
-};
+}};
 
-int8_t scale_chord_map[SCALE_AMOUNT][8] = {
-    {0, 0, 0, 0, 0, 0, 0, 0},                             // CHROMATIC
-    {MAJOR, MINOR, MINOR, MAJOR, MAJOR, MINOR, DIMINISH}, // IONIAN (Major Scale)
-    {MINOR, MINOR, MAJOR, MAJOR, MINOR, DIMINISH, MAJOR}, // DORIAN
-    {MINOR, MAJOR, MAJOR, MINOR, DIMINISH, MAJOR, MINOR}, // PHRYGIAN
-    {MAJOR, MAJOR, MINOR, DIMINISH, MAJOR, MINOR, MINOR}, // LYDIAN
-    {MAJOR, MINOR, DIMINISH, MAJOR, MINOR, MINOR, MAJOR}, // MIXOLYDIAN
-    {MINOR, DIMINISH, MAJOR, MINOR, MINOR, MAJOR, MAJOR}, // AEOLIAN (Natural Minor Scale)
-    {DIMINISH, MAJOR, MINOR, MINOR, MAJOR, MAJOR, MINOR}, // LOCRIAN
-    {MAJOR, MINOR, MAJOR, MAJOR, MINOR, MAJOR, MINOR},    // MAJOR_PENTATONIC
-    {MINOR, MAJOR, MINOR, MINOR, MAJOR, MINOR, MAJOR},    // MINOR_PENTATONIC
-    {MINOR, MAJOR, MINOR, MINOR, MAJOR, MINOR, MAJOR},    // BLUES
-    {MAJOR, MINOR, MINOR, MAJOR, MINOR, MAJOR, MAJOR},    // WHOLE_TONE
-    {MAJOR, MAJOR, MINOR, MINOR, MAJOR, MINOR, MINOR},    // AUGMENTED
-    {MINOR, MINOR, MAJOR, MAJOR, MINOR, MAJOR, MINOR},    // DIMINISHED
-    {MINOR, MAJOR, MINOR, MAJOR, MINOR, MAJOR, MINOR},    // HARMONIC_MINOR
-    {MAJOR, MINOR, MAJOR, MINOR, MAJOR, MINOR, MAJOR},    // MELODIC_MINOR
-    {MAJOR, MINOR, MAJOR, MINOR, MAJOR, MINOR, MAJOR},    // JAPANESE
-    {0, 0, 0, 0, 0, 0, 0},                                // CUSTOM1 Placeholder
-    {0, 0, 0, 0, 0, 0, 0}                                 // CUSTOM2 Placeholder
+// Runtime copy of the presets, the custom scales get overwritten by the configuration
+ScaleTable scale_table = scale_presets;
+int8_t (&scales)[SCALE_AMOUNT][16] = scale_table.steps;
 
-};
+// Number of steps in a scale before it wraps to the next octave
+constexpr uint8_t ScaleLength(const int8_t *scale)
+{
+    uint8_t length = 0;
+    while (length < 12 && scale[length] != -1)
+    {
+        length++;
+    }
+    return length;
+}
 
 uint8_t note_map[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
-uint8_t current_chord_mapping[12]; // Stores the current chord mapping for each of the 12 note keys
+uint8_t degree_map[16] = {0}; // Stores the scale degree played by each key
 
 void SetNoteMap(uint8_t scale, uint8_t root_note, bool flip_x, bool flip_y, std::function<void(uint8_t, bool)> markerCallback)
 {
@@ -130,6 +104,7 @@ void SetNoteMap(uint8_t scale, uint8_t root_note, bool flip_x, bool flip_y, std:
         // Calculate the note value by adding the scale step to the root note
         // and accounting for the octave wrap-around
         note_map[index] = (root_note + scale_notes[note_index] + (octave * 12));
+        degree_map[index] = note_index;
 
         isRootNote = (note_index == 0);
         // Use the provided callback to update the marker LEDs
@@ -139,12 +114,4 @@ void SetNoteMap(uint8_t scale, uint8_t root_note, bool flip_x, bool flip_y, std:
     }
 }
 
-void SetChordMapping(uint8_t scale)
-{
-    for (int i = 0; i < 12; i++)
-    {
-        current_chord_mapping[i] = scale_chord_map[scale][i % 7];
-    }
-}
-
 #endif // SCALES_HPP
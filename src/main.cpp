@@ -1,7 +1,8 @@
 #include "pinout.h"
 #include <Arduino.h>
 
-#include "Performance.hpp"
+#include "Libs/CpuMonitor.hpp"
+#include "Libs/DeferredLog.hpp"
 
 #include "Configuration.hpp"
 
@@ -13,19 +14,16 @@ DataManager calibration("/calibration_data.json");
 DataManager config("/configuration_data.json");
 
 #include <FastLED.h>
-
-DEFINE_GRADIENT_PALETTE(unwn_gp){0, 255, 246, 197, 128, 255, 178, 28, 255, 255, 83, 0};
-// DEFINE_GRADIENT_PALETTE(unwn_gp){0, 176, 65, 251, 127, 230, 2, 2, 255, 255, 111, 156};
-DEFINE_GRADIENT_PALETTE(topo_gp){0, 0, 107, 189, 128, 255, 147, 0, 255, 0, 255, 121};
-DEFINE_GRADIENT_PALETTE(alt_gp){0, 189, 70, 70, 255, 78, 75, 232};
-DEFINE_GRADIENT_PALETTE(acid_gp){0, 126, 255, 36, 255, 130, 0, 255};
-CRGBPalette16 palette[] = {unwn_gp, topo_gp, alt_gp, acid_gp};
+#include "Libs/Leds/Palettes.hpp"
 
 #include "Libs/Leds/LedManager.hpp"
 LedManager led_manager;
 
+#include "Libs/Leds/LedMirror.hpp"
+LedMirror led_mirror;
+
 TouchBlur touch_blur;
-NoBlur no_blur;
+Ripples ripples;
 Strips strips;
 Strum strum;
 QuickSettings quick;
@@ -45,6 +43,11 @@ Keyboard keyboard;
 uint8_t slider_sensor[] = {PIN_T1, PIN_T2, PIN_T3, PIN_T4, PIN_T5, PIN_T6, PIN_T7};
 TouchSlider slider;
 
+#include "Libs/Strummer.hpp"
+Strummer strummer;
+
+#include "Libs/Benchmarks.hpp"
+
 uint8_t marker = 0;
 
 #include "Libs/Button.hpp"
@@ -52,6 +55,7 @@ Button t_btn(PIN_TOUCH);
 Button m_btn(PIN_MODE);
 
 #include "Scales.hpp"
+#include "Chords.hpp"
 
 enum SliderMode
 {
@@ -85,7 +89,6 @@ void OnBankChange()
     keyboard.SetVelocityLut((Keyboard::Lut)kb_cfg[parameters.bank].velocity_curve);
     keyboard.SetAftertouchLut((Keyboard::Lut)kb_cfg[parameters.bank].aftertouch_curve);
     // Set Chord mode?
-    led_manager.UpdateTransition();
 }
 
 uint8_t current_chord = 0;
@@ -101,14 +104,14 @@ void ProcessStrum(int idx, Key::State state)
             current_key_idx = idx;
             current_base_note = note_map[idx] + (kb_cfg[parameters.bank].base_octave * 12);
             led_manager.SetNote(idx);
-            log_d("Pressed: idx=%d, base_note=%d, chord=%d", idx, current_base_note, current_chord);
+            LOG_DEFERRED("Pressed: idx=%d, base_note=%d, chord=%d", idx, current_base_note, current_chord);
             current_chord = current_chord_mapping[idx];
             led_manager.SetChord(current_chord);
         }
         else
         {
             current_chord = idx - 12;
-            current_chord_mapping[current_base_note] = current_chord;
+            current_chord_mapping[current_key_idx] = current_chord;
             led_manager.SetChord(current_chord);
         }
     }
@@ -117,19 +120,24 @@ void ProcessStrum(int idx, Key::State state)
 void ProcessSliderStrum(uint8_t idx, bool state)
 {
     if (cfg.mode == Mode::STRUM)
-        if (state)
-        {
-            int velocity = keyboard.GetPressure(current_key_idx);
-            log_d("velocity: %d", velocity);
-            midi_provider.SendChordNoteOn(idx, strum_chords[current_chord][idx] + current_base_note, velocity, kb_cfg[parameters.bank].channel);
-            led_manager.SetSliderLed(idx, 254);
-            FastLED.show();
-        }
-        else
-        {
-            midi_provider.SendChordNoteOff(idx, kb_cfg[parameters.bank].channel);
-            led_manager.SetSliderLed(idx, 25);
-        }
+    {
+        strummer.Cross(idx, state, slider.GetEventTime(), micros(), keyboard.GetPressure(current_key_idx));
+    }
+}
+
+void ProcessString(uint8_t idx, bool state, uint8_t velocity)
+{
+    if (state)
+    {
+        LOG_DEFERRED("velocity: %d", velocity);
+        midi_provider.SendChordNoteOn(idx, strum_chords[current_chord][idx] + current_base_note, velocity, kb_cfg[parameters.bank].channel);
+        led_manager.SetSliderLed(idx, 254);
+    }
+    else
+    {
+        midi_provider.SendChordNoteOff(idx, kb_cfg[parameters.bank].channel);
+        led_manager.SetSliderLed(idx, 25);
+    }
 }
 
 void ProcessKey(int idx, Key::State state)
@@ -138,21 +146,47 @@ void ProcessKey(int idx, Key::State state)
 
     if (state == Key::State::PRESSED)
     {
+        TRACE_STAMP(DISPATCH);
         uint8_t velocity = keyboard.GetVelocity(idx);
         midi_provider.SendNoteOn(idx, note, velocity, kb_cfg[parameters.bank].channel);
-        led_manager.SetPosition((uint8_t)(idx % 4), (uint8_t)(idx / 4));
-        led_manager.SetColor(255 - velocity * 2);
-        led_manager.SetSpeed((127 - velocity) / 2);
+        led_manager.NoteOn(idx, velocity);
     }
     else if (state == Key::State::RELEASED)
     {
         midi_provider.SendNoteOff(idx, kb_cfg[parameters.bank].channel);
+        led_manager.NoteOff(idx);
     }
     else if (state == Key::State::AFTERTOUCH)
     {
         uint8_t pressure = keyboard.GetAftertouch(idx);
-        log_d("Aftertouch: %d", pressure);
+        LOG_DEFERRED("Aftertouch: %d", pressure);
         midi_provider.SendAfterTouch(idx, (midi::DataByte)pressure, kb_cfg[parameters.bank].channel);
+        led_manager.NotePressure(idx, pressure);
+    }
+}
+
+void ProcessChord(int idx, Key::State state)
+{
+    uint8_t root = note_map[idx] + (kb_cfg[parameters.bank].base_octave * 12);
+
+    if (state == Key::State::PRESSED)
+    {
+        TRACE_STAMP(DISPATCH);
+        uint8_t velocity = keyboard.GetVelocity(idx);
+        const ChordVoicing &voicing = GetChordVoicing(current_chord_mapping[idx]);
+        midi_provider.SendChordOn(idx, root, voicing.notes, voicing.size, velocity, kb_cfg[parameters.bank].channel);
+        led_manager.NoteOn(idx, velocity);
+    }
+    else if (state == Key::State::RELEASED)
+    {
+        midi_provider.SendChordOff(idx, kb_cfg[parameters.bank].channel);
+        led_manager.NoteOff(idx);
+    }
+    else if (state == Key::State::AFTERTOUCH)
+    {
+        uint8_t pressure = keyboard.GetAftertouch(idx);
+        midi_provider.SendChordPressure(idx, pressure, kb_cfg[parameters.bank].channel);
+        led_manager.NotePressure(idx, pressure);
     }
 }
 
@@ -203,7 +237,7 @@ void ProcessSlider()
             // convert the float value to a 14 bit integer, with 0 being the float value 0.5
             value = (slider.GetPosition() - 0.5f) * 2.0f;
             parameters.bend = (value * 8191.0f);
-            log_d("bend: %d", (int)parameters.bend);
+            LOG_DEFERRED("bend: %d", (int)parameters.bend);
             midi_provider.SendPitchBend((int)parameters.bend, kb_cfg[parameters.bank].channel);
             led_manager.SetSlider(slider.GetPosition(), false);
             parameters.isBending = true;
@@ -249,6 +283,9 @@ void ProcessSlider()
 
 void ProcessSliderButton()
 {
+    // value selections keep scrolling after a flick
+    slider.SetMomentum(slider_mode != SliderMode::BEND && slider_mode != SliderMode::STRUMMING);
+
     switch (slider_mode)
     {
     case SliderMode::BEND:
@@ -289,6 +326,10 @@ void ProcessSliderButton()
 
 void ProcessModeButton()
 {
+    // play out strings still waiting, then release any chord still held from chord mode
+    strummer.Flush();
+    midi_provider.ClearChordPool(kb_cfg[parameters.bank].channel);
+
     switch (cfg.mode)
     {
     case Mode::KEYBOARD:
@@ -296,7 +337,7 @@ void ProcessModeButton()
         keyboard.RemoveOnStateChanged();
         keyboard.SetOnStateChanged(&ProcessKey);
         keyboard.SetMode(Mode::KEYBOARD);
-        led_manager.TransitionToPattern(&no_blur);
+        led_manager.TransitionToPattern(&ripples);
         slider_mode = SliderMode::BEND;
         ProcessSliderButton();
         break;
@@ -320,12 +361,20 @@ void ProcessModeButton()
         log_d("Mode: Strum");
         keyboard.RemoveOnStateChanged();
         keyboard.SetOnStateChanged(&ProcessStrum);
-        slider.onSensorTouched.Connect(ProcessSliderStrum);
         keyboard.SetMode(Mode::STRUM);
         led_manager.TransitionToPattern(&strum);
         slider_mode = SliderMode::STRUMMING;
         ProcessSliderButton();
         break;
+    case Mode::CHORD:
+        log_d("Mode: Chord");
+        keyboard.RemoveOnStateChanged();
+        keyboard.SetOnStateChanged(&ProcessChord);
+        keyboard.SetMode(Mode::CHORD);
+        led_manager.TransitionToPattern(&ripples);
+        slider_mode = SliderMode::BEND;
+        ProcessSliderButton();
+        break;
     case Mode::QUICK_SETTINGS:
         log_d("Mode: Quick Settings");
         slider_mode = SliderMode::QUICK;
@@ -335,68 +384,89 @@ void ProcessModeButton()
         led_manager.TransitionToPattern(&quick);
         break;
     }
+    log_d("Free heap: %u", ESP.getFreeHeap());
 }
 
-void ProcessButton(int idx, Button::State state)
+void NextSliderMode()
 {
-
-    if (state == Button::State::CLICKED)
+    if (cfg.mode == Mode::KEYBOARD || cfg.mode == Mode::CHORD)
     {
-        if (idx == PIN_TOUCH)
+        SliderMode allowed_modes[] = {SliderMode::BEND, SliderMode::MOD, SliderMode::OCTAVE, SliderMode::BANK};
+        int num_modes = sizeof(allowed_modes) / sizeof(allowed_modes[0]);
+        int current_index = -1;
+        for (int i = 0; i < num_modes; i++)
         {
-            log_d("Touch button clicked");
-            if (cfg.mode == Mode::KEYBOARD)
+            if (slider_mode == allowed_modes[i])
             {
-                SliderMode allowed_modes[] = {SliderMode::BEND, SliderMode::MOD, SliderMode::OCTAVE, SliderMode::BANK};
-                int num_modes = sizeof(allowed_modes) / sizeof(allowed_modes[0]);
-                int current_index = -1;
-                for (int i = 0; i < num_modes; i++)
-                {
-                    if (slider_mode == allowed_modes[i])
-                    {
-                        current_index = i;
-                        break;
-                    }
-                }
-                current_index = (current_index + 1) % num_modes;
-                slider_mode = allowed_modes[current_index];
+                current_index = i;
+                break;
             }
-            else if (cfg.mode == Mode::STRUM)
+        }
+        current_index = (current_index + 1) % num_modes;
+        slider_mode = allowed_modes[current_index];
+    }
+    else if (cfg.mode == Mode::STRUM)
+    {
+        SliderMode allowed_modes[] = {SliderMode::STRUMMING, SliderMode::OCTAVE, SliderMode::BANK};
+        int num_modes = sizeof(allowed_modes) / sizeof(allowed_modes[0]);
+        int current_index = -1;
+        for (int i = 0; i < num_modes; i++)
+        {
+            if (slider_mode == allowed_modes[i])
             {
-                SliderMode allowed_modes[] = {SliderMode::STRUMMING, SliderMode::OCTAVE, SliderMode::BANK};
-                int num_modes = sizeof(allowed_modes) / sizeof(allowed_modes[0]);
-                int current_index = -1;
-                for (int i = 0; i < num_modes; i++)
-                {
-                    if (slider_mode == allowed_modes[i])
-                    {
-                        current_index = i;
-                        break;
-                    }
-                }
-                current_index = (current_index + 1) % num_modes;
-                slider_mode = allowed_modes[current_index];
+                current_index = i;
+                break;
             }
-            else if (cfg.mode == Mode::XY_PAD || cfg.mode == Mode::STRIPS)
-            {
-                SliderMode allowed_modes[] = {SliderMode::SLEW, SliderMode::BANK};
-                int num_modes = sizeof(allowed_modes) / sizeof(allowed_modes[0]);
-                int current_index = -1;
-                for (int i = 0; i < num_modes; i++)
-                {
-                    if (slider_mode == allowed_modes[i])
-                    {
-                        current_index = i;
-                        break;
-                    }
-                }
-                current_index = (current_index + 1) % num_modes;
-                slider_mode = allowed_modes[current_index];
-            }
-            else if (cfg.mode == Mode::QUICK_SETTINGS)
+        }
+        current_index = (current_index + 1) % num_modes;
+        slider_mode = allowed_modes[current_index];
+    }
+    else if (cfg.mode == Mode::XY_PAD || cfg.mode == Mode::STRIPS)
+    {
+        SliderMode allowed_modes[] = {SliderMode::SLEW, SliderMode::BANK};
+        int num_modes = sizeof(allowed_modes) / sizeof(allowed_modes[0]);
+        int current_index = -1;
+        for (int i = 0; i < num_modes; i++)
+        {
+            if (slider_mode == allowed_modes[i])
             {
-                slider_mode = SliderMode::QUICK;
+                current_index = i;
+                break;
             }
+        }
+        current_index = (current_index + 1) % num_modes;
+        slider_mode = allowed_modes[current_index];
+    }
+    else if (cfg.mode == Mode::QUICK_SETTINGS)
+    {
+        slider_mode = SliderMode::QUICK;
+    }
+}
+
+void ProcessSliderGesture(Gesture gesture, int8_t direction)
+{
+    // strumming taps are notes, not gestures
+    if (slider_mode == SliderMode::STRUMMING)
+    {
+        return;
+    }
+    if (gesture == Gesture::DOUBLE_TAP)
+    {
+        log_d("Slider double tap");
+        NextSliderMode();
+        ProcessSliderButton();
+    }
+}
+
+void ProcessButton(int idx, Button::State state)
+{
+
+    if (state == Button::State::CLICKED)
+    {
+        if (idx == PIN_TOUCH)
+        {
+            log_d("Touch button clicked");
+            NextSliderMode();
             ProcessSliderButton();
         }
 
@@ -473,6 +543,8 @@ void ProcessButton(int idx, Button::State state)
                 {
                     midi_provider.SendNoteOff(i, kb_cfg[parameters.bank].channel);
                 }
+                // chord mode keeps its notes in the chord pool
+                midi_provider.ClearChordPool(kb_cfg[parameters.bank].channel);
             }
         }
     }
@@ -520,6 +592,89 @@ void ApplyConfiguration()
     cfg.mode = Mode::KEYBOARD;
 }
 
+void PrintCpuReport(const CpuMonitor::Report &report)
+{
+    Serial.printf("CPU over %lu ms, permille of a core\n", report.window / 1000);
+    for (uint8_t slot = 0; slot < CpuMonitor::SLOT_AMOUNT; slot++)
+    {
+        Serial.printf("  %-8s core %d %5u\n", CpuMonitor::SlotName(slot), CpuMonitor::SLOT_CORE[slot], report.load[slot]);
+    }
+    for (uint8_t core = 0; core < CpuMonitor::CORE_AMOUNT; core++)
+    {
+        Serial.printf("  core %d   idle %5u other %5u\n", core, report.idle[core], report.other[core]);
+    }
+    Serial.printf("Loop %u times, period min %u avg %u max %u us\n", report.loops, report.loopMin, report.loopAvg, report.loopMax);
+    for (uint8_t i = 0; i < CpuMonitor::HISTOGRAM_SIZE; i++)
+    {
+        Serial.printf("  >= %5u us %u\n", CpuMonitor::BucketStart(i), report.histogram[i]);
+    }
+}
+
+// Rates the slider, pattern and LED output tasks keep over their last second, only printed on request
+void PrintTaskStats()
+{
+    Serial.printf("Slider %.1f Hz, %.1f us per update\n", slider.GetUpdateRate(), slider.GetUpdateTime());
+    Serial.printf("Pattern %u frames, %u cycles per frame\n", led_manager.GetPatternFrames(), led_manager.GetPatternCycles());
+    LedOutput<NUM_LEDS> &output = led_manager.GetOutput();
+    Serial.printf("LEDs %u frames, %.1f us per show (off the loop), %.1f us per submit, %u replaced\n",
+                  output.GetShownFrames(), output.GetShowTime(), output.GetSubmitTime(), output.GetReplacedFrames());
+}
+
+// 0 stops the CPU monitor, 1 starts it, 2 reports over SysEx and serial what was measured since the last report,
+// the task rates with it even when the monitor is stopped
+void ProcessCpuCommand(uint8_t command)
+{
+    if (command == 0)
+    {
+        CpuMonitor::Stop();
+    }
+    else if (command == 1)
+    {
+        CpuMonitor::Start();
+    }
+    else if (command == 2)
+    {
+        if (CpuMonitor::IsRunning())
+        {
+            CpuMonitor::Report report = CpuMonitor::Collect();
+            uint8_t message[CpuMonitor::MAX_MESSAGE];
+            uint16_t size = CpuMonitor::Pack(report, message);
+            midi_provider.SendSysEx(size, message);
+            PrintCpuReport(report);
+        }
+        PrintTaskStats();
+    }
+}
+
+#ifdef LATENCY_TRACE
+// Sends the press to wire latencies measured since the last report over SysEx and serial
+void ReportLatency()
+{
+    uint8_t message[LatencyTrace::MAX_MESSAGE];
+    uint16_t size = LatencyTrace::Pack(message);
+    midi_provider.SendSysEx(size, message);
+
+    Serial.printf("Press to wire latency, us\n");
+    for (uint8_t stage = LatencyTrace::THRESHOLD; stage < LatencyTrace::STAGE_AMOUNT; stage++)
+    {
+        const LatencyTrace::StageStats &stats = LatencyTrace::Get(stage);
+        if (stats.count == 0)
+        {
+            continue;
+        }
+        Serial.printf("  %-9s %5u presses, min %u avg %u max %u\n", LatencyTrace::StageName(stage), stats.count, stats.min, (uint32_t)(stats.sum / stats.count), stats.max);
+        for (uint8_t i = 0; i < LatencyTrace::HISTOGRAM_SIZE; i++)
+        {
+            if (stats.histogram[i] > 0)
+            {
+                Serial.printf("    >= %4u us %u\n", LatencyTrace::BucketStart(i), stats.histogram[i]);
+            }
+        }
+    }
+    LatencyTrace::Reset();
+}
+#endif
+
 void ProcessSysEx(byte *data, unsigned length)
 {
     log_d("SysEx received");
@@ -550,6 +705,73 @@ void ProcessSysEx(byte *data, unsigned length)
         LoadConfiguration(config);
         ApplyConfiguration();
     }
+
+    if (data[2] == 127 && data[3] == 7 && data[4] == 6 && length > 6)
+    {
+        log_d("SysEx LED mirror %s", data[5] ? "on" : "off");
+        led_mirror.SetEnabled(data[5]);
+    }
+
+    if (data[2] == 127 && data[3] == 7 && data[4] == 8 && length > 6)
+    {
+        log_d("SysEx CPU monitor command %d", data[5]);
+        ProcessCpuCommand(data[5]);
+    }
+
+#ifdef LATENCY_TRACE
+    if (data[2] == 127 && data[3] == 7 && data[4] == 10)
+    {
+        log_d("SysEx latency report request");
+        ReportLatency();
+    }
+#endif
+}
+
+// Hands the next LED mirror message to the lowest priority MIDI queue, once the previous one went out
+void ProcessLedMirror()
+{
+    if (led_mirror.IsEnabled() && !midi_provider.IsSysExQueued())
+    {
+        uint8_t message[LedMirror::MAX_MESSAGE];
+        uint16_t size = led_mirror.Update(millis(), message);
+        if (size > 0)
+        {
+            midi_provider.QueueSysEx(size, message);
+        }
+    }
+    midi_provider.FlushQueuedSysEx();
+}
+
+// Single character commands on the serial port: '+' starts the CPU monitor, '-' stops it, '?' reports,
+// 'l' reports the press to wire latency when the build traces it, 'b' runs the benchmarks when built in.
+// The benchmarks hold the loop for a few seconds.
+void ProcessSerial()
+{
+    while (Serial.available() > 0)
+    {
+        switch (Serial.read())
+        {
+        case '+':
+            ProcessCpuCommand(1);
+            break;
+        case '-':
+            ProcessCpuCommand(0);
+            break;
+        case '?':
+            ProcessCpuCommand(2);
+            break;
+#ifdef LATENCY_TRACE
+        case 'l':
+            ReportLatency();
+            break;
+#endif
+#ifdef BENCHMARKS
+        case 'b':
+            Benchmarks::Run(Serial);
+            break;
+#endif
+        }
+    }
 }
 
 bool CalibrationRoutine()
@@ -568,7 +790,7 @@ bool CalibrationRoutine()
         while (m_btn.GetState() != Button::State::CLICKED)
         {
             Serial.printf("Getting raw value: %d\n", adc.GetRaw());
-            FastLED.show();
+            led_manager.Show();
             m_btn.Update();
         }
         m_btn.Update();
@@ -592,6 +814,7 @@ void setup()
     Serial.begin(115200);
     Serial.setDebugOutput(true);
     delay(1000);
+    DeferredLog::Start();
 
     midi_provider.SetHandleSystemExclusive(ProcessSysEx);
     // Button initialization
@@ -605,6 +828,10 @@ void setup()
 
     // slider initialization
     slider.Init(slider_sensor);
+    slider.onGesture.Connect(&ProcessSliderGesture);
+    slider.onSensorTouched.Connect(&ProcessSliderStrum);
+    strummer.onString.Connect(&ProcessString);
+    slider.Start();
 
     // ADC initialization
     AdcChannelConfig adc_config;
@@ -669,15 +896,18 @@ void setup()
 
 void loop()
 {
+    CpuMonitor::OnLoop();
+    CpuSection section(CpuMonitor::LOOP);
 
     midi_provider.Read();
 
     t_btn.Update();
     m_btn.Update();
-    slider.Update();
+    slider.DispatchEvents();
+    strummer.Update(micros());
 
     keyboard.Update();
-    fill_solid(matrixleds, 16, CRGB::Black);
+    led_manager.ClearMarkers();
 
     if (cfg.mode == Mode::XY_PAD)
     {
@@ -710,7 +940,7 @@ void loop()
         }
     }
 
-    else if (cfg.mode == Mode::KEYBOARD)
+    else if (cfg.mode == Mode::KEYBOARD || cfg.mode == Mode::CHORD)
     {
         led_manager.DrawMarkers();
     }
@@ -742,6 +972,7 @@ void loop()
     }
 
     ProcessSlider();
-    led_manager.RunPattern();
-    FastLED.show();
+    led_manager.Render();
+    ProcessLedMirror();
+    ProcessSerial();
 }
@@ -0,0 +1,246 @@
+// Button debouncing and slider touch sensing on the host stand-ins, run with `pio test -e native`.
+// Time is virtual, each test steps the clock and runs the expired timers like the timer task would.
+
+#include <unity.h>
+#include <Arduino.h>
+#include <freertos/timers.h>
+#include <driver/touch_sensor.h>
+#include "Libs/Button.hpp"
+#include "Libs/TouchSlider.hpp"
+
+#define BUTTON_PIN 10
+#define PAD_BASE 30000   // raw value of an untouched pad
+#define PAD_FINGER 40000 // raw delta of a finger right over a pad
+
+static uint8_t padPins[NUM_SENSORS] = {1, 2, 3, 4, 5, 6, 7};
+
+// Moves the clock ms at a time, firing the timers that expire on the way
+static void Advance(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++)
+    {
+        HostClock::Advance(1000);
+        HostTimers::Run();
+    }
+}
+
+// Collects the state changes a button reports from Update()
+struct ButtonLog
+{
+    std::vector<Button::State> states;
+
+    void Attach(Button &button)
+    {
+        button.onStateChanged.Connect([this](int id, Button::State state)
+                                      { states.push_back(state); });
+    }
+
+    // Runs the main loop side for ms, once per ms
+    void Poll(Button &button, uint32_t ms)
+    {
+        for (uint32_t i = 0; i < ms; i++)
+        {
+            Advance(1);
+            button.Update();
+        }
+    }
+
+    bool Saw(Button::State state) const
+    {
+        return std::find(states.begin(), states.end(), state) != states.end();
+    }
+
+    size_t Count(Button::State state) const
+    {
+        return std::count(states.begin(), states.end(), state);
+    }
+};
+
+// The contact is active low, the pin idles high on its pull-up
+static void Contact(bool closed)
+{
+    HostGpio::Set(BUTTON_PIN, closed ? LOW : HIGH);
+}
+
+void setUp()
+{
+    HostClock::Reset();
+    HostGpio::Get(BUTTON_PIN) = HostGpio::Pin();
+}
+
+void tearDown()
+{
+    HostTimers::Clear();
+    detachInterrupt(BUTTON_PIN);
+}
+
+void test_button_bounces_into_one_press()
+{
+    Button button(BUTTON_PIN, 0, 10);
+    button.Init();
+    ButtonLog log;
+    log.Attach(button);
+
+    // contact chatter for a few ms, then closed
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        Contact(true);
+        log.Poll(button, 1);
+        Contact(false);
+        log.Poll(button, 1);
+    }
+    Contact(true);
+    log.Poll(button, 9);
+    TEST_ASSERT_FALSE(button.IsPressed());
+
+    log.Poll(button, 5);
+    TEST_ASSERT_TRUE(button.IsPressed());
+    TEST_ASSERT_EQUAL(1, log.Count(Button::PRESSED));
+}
+
+void test_button_ignores_a_glitch_shorter_than_the_debounce()
+{
+    Button button(BUTTON_PIN, 0, 10);
+    button.Init();
+    ButtonLog log;
+    log.Attach(button);
+
+    Contact(true);
+    log.Poll(button, 3);
+    Contact(false);
+    log.Poll(button, 50);
+
+    TEST_ASSERT_FALSE(button.IsPressed());
+    TEST_ASSERT_TRUE(log.states.empty());
+}
+
+void test_button_short_press_clicks()
+{
+    Button button(BUTTON_PIN, 0, 10);
+    button.Init();
+    ButtonLog log;
+    log.Attach(button);
+
+    Contact(true);
+    log.Poll(button, 100);
+    Contact(false);
+    log.Poll(button, 30);
+
+    TEST_ASSERT_TRUE(log.Saw(Button::PRESSED));
+    TEST_ASSERT_TRUE(log.Saw(Button::CLICKED));
+    TEST_ASSERT_FALSE(log.Saw(Button::LONG_PRESSED));
+    TEST_ASSERT_EQUAL(Button::IDLE, button.GetState());
+}
+
+void test_button_held_long_presses()
+{
+    Button button(BUTTON_PIN, 0, 10);
+    button.SetLongPressTime(500);
+    button.Init();
+    ButtonLog log;
+    log.Attach(button);
+
+    Contact(true);
+    log.Poll(button, 400);
+    TEST_ASSERT_FALSE(log.Saw(Button::LONG_PRESSED));
+    log.Poll(button, 200);
+    TEST_ASSERT_TRUE(log.Saw(Button::LONG_PRESSED));
+
+    Contact(false);
+    log.Poll(button, 30);
+    TEST_ASSERT_TRUE(log.Saw(Button::LONG_RELEASED));
+    TEST_ASSERT_FALSE(log.Saw(Button::CLICKED));
+}
+
+// Latches one scan with a finger at position, 0 to 1, or none when position is negative
+static void Scan(TouchSlider &slider, float position)
+{
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        float finger = 0.0f;
+        if (position >= 0.0f)
+        {
+            float distance = fabsf(position * (NUM_SENSORS - 1) - i) / 1.5f;
+            finger = PAD_FINGER * max(0.0f, 1.0f - distance);
+        }
+        HostTouch::Set(digitalPinToTouchChannel(padPins[i]), PAD_BASE + (uint32_t)finger);
+    }
+    HostTouch::Scan();
+    Advance(SLIDER_TASK_PERIOD_MS);
+    slider.Update();
+}
+
+static void InitSlider(TouchSlider &slider)
+{
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+        HostTouch::Set(digitalPinToTouchChannel(padPins[i]), PAD_BASE);
+    slider.Init(padPins);
+}
+
+void test_slider_untouched_pads_report_no_touch()
+{
+    TouchSlider slider;
+    InitSlider(slider);
+
+    for (uint8_t i = 0; i < 100; i++)
+        Scan(slider, -1.0f);
+
+    TEST_ASSERT_FALSE(slider.IsTouched());
+    TEST_ASSERT_EQUAL(0, slider.GetTouchCount());
+}
+
+void test_slider_finger_is_found_where_it_rests()
+{
+    const float positions[] = {0.0f, 0.3f, 0.5f, 0.85f, 1.0f};
+    for (float position : positions)
+    {
+        TouchSlider slider;
+        InitSlider(slider);
+
+        for (uint8_t i = 0; i < 60; i++)
+            Scan(slider, position);
+
+        TEST_ASSERT_TRUE(slider.IsTouched());
+        TEST_ASSERT_EQUAL(1, slider.GetTouchCount());
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, position, slider.GetPosition());
+    }
+}
+
+void test_slider_lifted_finger_releases()
+{
+    TouchSlider slider;
+    InitSlider(slider);
+
+    for (uint8_t i = 0; i < 60; i++)
+        Scan(slider, 0.5f);
+    TEST_ASSERT_TRUE(slider.IsTouched());
+
+    for (uint8_t i = 0; i < 60; i++)
+        Scan(slider, -1.0f);
+    TEST_ASSERT_FALSE(slider.IsTouched());
+}
+
+void test_slider_set_position_is_reported_before_and_after_it_is_applied()
+{
+    TouchSlider slider;
+    InitSlider(slider);
+
+    slider.SetPosition(0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, slider.GetPosition());
+    slider.Update();
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, slider.GetPosition());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_button_bounces_into_one_press);
+    RUN_TEST(test_button_ignores_a_glitch_shorter_than_the_debounce);
+    RUN_TEST(test_button_short_press_clicks);
+    RUN_TEST(test_button_held_long_presses);
+    RUN_TEST(test_slider_untouched_pads_report_no_touch);
+    RUN_TEST(test_slider_finger_is_found_where_it_rests);
+    RUN_TEST(test_slider_lifted_finger_releases);
+    RUN_TEST(test_slider_set_position_is_reported_before_and_after_it_is_applied);
+    return UNITY_END();
+}